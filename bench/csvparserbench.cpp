@@ -0,0 +1,63 @@
+#include "utils/csvparser.h"
+#include "utils/stringoperations.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace utils::str;
+
+// ~16MB of csv data with numeric and text columns, optionally with quoted fields
+static std::string createCsv(bool quoted)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> numberDist(0, 1000000);
+
+    std::string result;
+    while (result.size() < 16 * 1024 * 1024)
+    {
+        result += std::to_string(numberDist(rng));
+        result += ',';
+        result += quoted ? "\"Lastname, Firstname\"" : "Firstname Lastname";
+        result += ',';
+        result += std::to_string(numberDist(rng));
+        result += ".25,some longer text column value,";
+        result += std::to_string(numberDist(rng));
+        result += '\n';
+    }
+
+    return result;
+}
+
+static void splittedViewLinesBench(benchmark::State& state)
+{
+    auto data = createCsv(false);
+    for (auto _ : state) {
+        size_t fields = 0;
+        for (auto line : split_range(data, '\n', split_opt::no_empty))
+        {
+            fields += splitted_view(line, ',').size();
+        }
+        benchmark::DoNotOptimize(fields);
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+
+static void csvParserBench(benchmark::State& state)
+{
+    auto data = createCsv(state.range(0) != 0);
+    for (auto _ : state) {
+        size_t fields = 0;
+        csv_parser parser(data);
+        while (parser.read_row())
+        {
+            fields += parser.fields().size();
+        }
+        benchmark::DoNotOptimize(fields);
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+
+BENCHMARK(splittedViewLinesBench)->Unit(benchmark::kMillisecond);
+BENCHMARK(csvParserBench)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
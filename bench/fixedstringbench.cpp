@@ -0,0 +1,83 @@
+#include "utils/fixedstring.h"
+#include "utils/stringoperations.h"
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include <string>
+
+using namespace utils;
+
+// keys between 16 and 32 characters: too long for the small string buffer of std::string
+static const std::array<std::string, 4> s_keys = {
+    "  Customer.Address.Street  ",
+    "\tOrder.Line.UnitPrice\n",
+    " Shipment.Carrier.TrackingId",
+    "Invoice.Payment.DueDate    ",
+};
+
+static void trimLowercaseStdStringBench(benchmark::State& state)
+{
+    for (auto _ : state) {
+        for (auto& key : s_keys)
+        {
+            std::string result = str::lowercase(str::trimmed_view(key));
+            benchmark::DoNotOptimize(result.data());
+        }
+    }
+}
+
+static void trimLowercaseFixedStringBench(benchmark::State& state)
+{
+    for (auto _ : state) {
+        for (auto& key : s_keys)
+        {
+            fixed_string<32> result(str::trimmed_view(key));
+            str::lowercase_in_place(result);
+            benchmark::DoNotOptimize(result.data());
+        }
+    }
+}
+
+static void toStringStdStringBench(benchmark::State& state)
+{
+    uint64_t value = 12345678901234567890u;
+    for (auto _ : state) {
+        auto result = str::toString(value++);
+        benchmark::DoNotOptimize(result.data());
+    }
+}
+
+static void toStringFixedStringBench(benchmark::State& state)
+{
+    uint64_t value = 12345678901234567890u;
+    for (auto _ : state) {
+        auto result = str::toString<24>(value++);
+        benchmark::DoNotOptimize(result.data());
+    }
+}
+
+static void joinStdStringBench(benchmark::State& state)
+{
+    std::array<std::string_view, 3> parts = {"Customer", "Address", "Street"};
+    for (auto _ : state) {
+        auto result = str::join(parts, ".");
+        benchmark::DoNotOptimize(result.data());
+    }
+}
+
+static void joinFixedStringBench(benchmark::State& state)
+{
+    std::array<std::string_view, 3> parts = {"Customer", "Address", "Street"};
+    for (auto _ : state) {
+        fixed_string<32> result;
+        str::join_into(result, parts, ".");
+        benchmark::DoNotOptimize(result.data());
+    }
+}
+
+BENCHMARK(trimLowercaseStdStringBench);
+BENCHMARK(trimLowercaseFixedStringBench);
+BENCHMARK(toStringStdStringBench);
+BENCHMARK(toStringFixedStringBench);
+BENCHMARK(joinStdStringBench);
+BENCHMARK(joinFixedStringBench);
@@ -0,0 +1,57 @@
+#include "utils/hash.h"
+
+#include <benchmark/benchmark.h>
+#include <functional>
+#include <string>
+#include <string_view>
+
+static std::string createKey(size_t size)
+{
+    std::string result(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+    {
+        result[i] = char('a' + (i * 7) % 26);
+    }
+
+    return result;
+}
+
+static void stdHashBench(benchmark::State& state)
+{
+    auto key = createKey(size_t(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::hash<std::string_view>()(key));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(key.size()));
+}
+
+static void hash64Bench(benchmark::State& state)
+{
+    auto key = createKey(size_t(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::hash::hash64(key));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(key.size()));
+}
+
+static void hasherBench(benchmark::State& state)
+{
+    // the data is added in chunks of 4KB
+    auto data = createKey(size_t(state.range(0)));
+    for (auto _ : state) {
+        utils::hash::Hasher hasher;
+        for (size_t pos = 0; pos < data.size(); pos += 4096)
+        {
+            hasher.update(std::string_view(data).substr(pos, 4096));
+        }
+        benchmark::DoNotOptimize(hasher.digest());
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(data.size()));
+}
+
+BENCHMARK(stdHashBench)->Arg(8)->Arg(32)->Arg(256)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(hash64Bench)->Arg(8)->Arg(32)->Arg(256)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(hasherBench)->Arg(1 << 20);
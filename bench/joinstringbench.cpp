@@ -1,3 +1,5 @@
+#include "utils/stringoperations.h"
+
 #include <benchmark/benchmark.h>
 #include <iostream>
 #include <numeric>
@@ -106,6 +108,102 @@ static void joinBoostBench(benchmark::State& state)
     }
 }
 
+static void utilsJoinBench(benchmark::State& state)
+{
+    std::vector<std::string> toJoin = {{"My pretty pretty pretty string 1",
+        "My pretty pretty pretty string 2",
+        "My pretty pretty pretty string 3",
+        "My pretty pretty pretty string 4",
+        "My pretty pretty pretty string 5"}};
+
+    for (auto _ : state)
+    {
+        auto joined = utils::str::join(toJoin, ", ");
+        if (joined.size() != (32 * 5) + (2 * 4))
+        {
+            throw std::runtime_error("error");
+        }
+    }
+}
+
+static void utilsJoinIntoBench(benchmark::State& state)
+{
+    std::vector<std::string> toJoin = {{"My pretty pretty pretty string 1",
+        "My pretty pretty pretty string 2",
+        "My pretty pretty pretty string 3",
+        "My pretty pretty pretty string 4",
+        "My pretty pretty pretty string 5"}};
+
+    // the output buffer is reused, no allocations in the loop
+    std::string joined;
+    for (auto _ : state)
+    {
+        joined.clear();
+        utils::str::join_into(joined, toJoin, ", ");
+        if (joined.size() != (32 * 5) + (2 * 4))
+        {
+            throw std::runtime_error("error");
+        }
+    }
+}
+
+static void joinNumbersStreamBench(benchmark::State& state)
+{
+    std::vector<int> toJoin(100);
+    std::iota(toJoin.begin(), toJoin.end(), 100000);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(joinStream(toJoin, ", "));
+    }
+}
+
+static void utilsJoinNumbersBench(benchmark::State& state)
+{
+    std::vector<int> toJoin(100);
+    std::iota(toJoin.begin(), toJoin.end(), 100000);
+
+    std::string joined;
+    for (auto _ : state)
+    {
+        joined.clear();
+        utils::str::join_into(joined, toJoin, ", ");
+        benchmark::DoNotOptimize(joined);
+    }
+}
+
+static void utilsJoinSplitRangeBench(benchmark::State& state)
+{
+    const std::string line = "field one,field two,field three,field four,field five,field six,field seven";
+
+    std::string joined;
+    for (auto _ : state)
+    {
+        joined.clear();
+        utils::str::join_into(joined, utils::str::split_range(line, ','), ";");
+        benchmark::DoNotOptimize(joined);
+    }
+}
+
+static void utilsJoinSplittedViewBench(benchmark::State& state)
+{
+    const std::string line = "field one,field two,field three,field four,field five,field six,field seven";
+
+    std::string joined;
+    for (auto _ : state)
+    {
+        joined.clear();
+        utils::str::join_into(joined, utils::str::splitted_view(line, ','), ";");
+        benchmark::DoNotOptimize(joined);
+    }
+}
+
 BENCHMARK(joinStreamBench);
 BENCHMARK(joinBench);
 BENCHMARK(joinBoostBench);
+BENCHMARK(utilsJoinBench);
+BENCHMARK(utilsJoinIntoBench);
+BENCHMARK(joinNumbersStreamBench);
+BENCHMARK(utilsJoinNumbersBench);
+BENCHMARK(utilsJoinSplitRangeBench);
+BENCHMARK(utilsJoinSplittedViewBench);
@@ -0,0 +1,137 @@
+#include "utils/bufferedreader.h"
+#include "utils/filereader.h"
+#include "utils/mmapreader.h"
+#include "utils/posixfilereader.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+static const char* s_benchFile = "readerbench.bin";
+
+static void createBenchFile(size_t size)
+{
+    std::vector<char> data(size, 'x');
+    std::ofstream file(s_benchFile, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+}
+
+template <typename Reader>
+static void sequentialReadBench(benchmark::State& state)
+{
+    // the file is read in chunks of 4KB, as a decoder would
+    constexpr size_t fileSize = 64 * 1024 * 1024;
+    createBenchFile(fileSize);
+
+    std::vector<uint8_t> chunk(4096);
+    for (auto _ : state) {
+        Reader reader;
+        reader.open(s_benchFile);
+        while (reader.read(chunk.data(), chunk.size()) > 0)
+        {
+            benchmark::DoNotOptimize(chunk.data());
+        }
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(fileSize));
+    std::remove(s_benchFile);
+}
+
+template <typename Reader>
+static void sequentialPeekBench(benchmark::State& state)
+{
+    constexpr size_t fileSize = 64 * 1024 * 1024;
+    createBenchFile(fileSize);
+
+    for (auto _ : state) {
+        Reader reader;
+        reader.open(s_benchFile);
+        for (auto span = reader.peek(4096); !span.empty(); span = reader.peek(4096))
+        {
+            benchmark::DoNotOptimize(span.data);
+            reader.consume(span.size);
+        }
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(fileSize));
+    std::remove(s_benchFile);
+}
+
+static void fileReaderBench(benchmark::State& state)
+{
+    sequentialReadBench<utils::FileReader>(state);
+}
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+static void mmapReaderBench(benchmark::State& state)
+{
+    sequentialReadBench<utils::MmapReader>(state);
+}
+#endif
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+static void posixFileReaderBench(benchmark::State& state)
+{
+    sequentialReadBench<utils::PosixFileReader>(state);
+}
+#endif
+
+static void fileReaderPeekBench(benchmark::State& state)
+{
+    sequentialPeekBench<utils::FileReader>(state);
+}
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+static void mmapReaderPeekBench(benchmark::State& state)
+{
+    sequentialPeekBench<utils::MmapReader>(state);
+}
+#endif
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+using BufferedBenchSource = utils::PosixFileReader;
+#else
+using BufferedBenchSource = utils::FileReader;
+#endif
+
+static void bufferedReaderBench(benchmark::State& state)
+{
+    // decodes a 64KB buffered stream, the work per byte stands in for the decoding
+    constexpr size_t fileSize = 64 * 1024 * 1024;
+    createBenchFile(fileSize);
+
+    std::vector<uint8_t> chunk(4096);
+    for (auto _ : state) {
+        utils::BufferedReader reader(std::make_unique<BufferedBenchSource>(), 64 * 1024, uint32_t(state.range(0)));
+        reader.open(s_benchFile);
+
+        uint64_t sum = 0;
+        while (auto bytes = reader.read(chunk.data(), chunk.size()))
+        {
+            for (uint64_t i = 0; i < bytes; ++i)
+            {
+                sum = sum * 31 + chunk[i];
+            }
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(fileSize));
+    std::remove(s_benchFile);
+}
+
+BENCHMARK(fileReaderBench);
+#if !defined(WIN32) && !defined(__MINGW32__)
+BENCHMARK(mmapReaderBench);
+#endif
+#if !defined(WIN32) && !defined(__MINGW32__)
+BENCHMARK(posixFileReaderBench);
+#endif
+BENCHMARK(fileReaderPeekBench);
+#if !defined(WIN32) && !defined(__MINGW32__)
+BENCHMARK(mmapReaderPeekBench);
+#endif
+BENCHMARK(bufferedReaderBench)->Arg(0)->Arg(1)->Arg(2);
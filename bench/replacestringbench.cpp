@@ -0,0 +1,112 @@
+#include "utils/stringoperations.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace utils::str;
+
+// Template of about 1MB with a placeholder every few words
+static std::string createTemplate(int placeholders)
+{
+    std::string result;
+    while (result.size() < 1024 * 1024)
+    {
+        for (int i = 0; i < placeholders; ++i)
+        {
+            result += "Some template text {{placeholder" + std::to_string(i) + "}} followed by more text\n";
+        }
+    }
+
+    return result;
+}
+
+// The previous implementation: std::string::replace for every match
+static void replaceLoop(std::string& aString, std::string_view toSearch, std::string_view toReplace)
+{
+    size_t startPos = 0;
+    size_t foundPos;
+
+    while (std::string::npos != (foundPos = aString.find(toSearch, startPos)))
+    {
+        aString.replace(foundPos, toSearch.length(), toReplace);
+        startPos = foundPos + toReplace.size();
+    }
+}
+
+static void replaceLoopBench(benchmark::State& state)
+{
+    auto input = createTemplate(1);
+    for (auto _ : state) {
+        auto str = input;
+        replaceLoop(str, "{{placeholder0}}", "a longer replacement value");
+        benchmark::DoNotOptimize(str);
+    }
+}
+
+static void replaceBench(benchmark::State& state)
+{
+    auto input = createTemplate(1);
+    for (auto _ : state) {
+        auto str = input;
+        replace(str, "{{placeholder0}}", "a longer replacement value");
+        benchmark::DoNotOptimize(str);
+    }
+}
+
+static void dos2unixBench(benchmark::State& state)
+{
+    std::string input;
+    while (input.size() < 1024 * 1024)
+    {
+        input += "a line of text\r\n";
+    }
+
+    for (auto _ : state) {
+        auto str = input;
+        dos2unix(str);
+        benchmark::DoNotOptimize(str);
+    }
+}
+
+static void replaceManyPatternsLoopBench(benchmark::State& state)
+{
+    auto placeholders = static_cast<int>(state.range(0));
+    auto input        = createTemplate(placeholders);
+    for (auto _ : state) {
+        auto str = input;
+        for (int i = 0; i < placeholders; ++i)
+        {
+            replace(str, "{{placeholder" + std::to_string(i) + "}}", "value " + std::to_string(i));
+        }
+        benchmark::DoNotOptimize(str);
+    }
+}
+
+static void replaceAllBench(benchmark::State& state)
+{
+    auto placeholders = static_cast<int>(state.range(0));
+    auto input        = createTemplate(placeholders);
+
+    std::vector<std::string> patterns, values;
+    for (int i = 0; i < placeholders; ++i)
+    {
+        patterns.push_back("{{placeholder" + std::to_string(i) + "}}");
+        values.push_back("value " + std::to_string(i));
+    }
+
+    std::vector<replacer::replacement> replacements;
+    for (int i = 0; i < placeholders; ++i)
+    {
+        replacements.emplace_back(patterns[i], values[i]);
+    }
+
+    replacer templateReplacer(replacements);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(templateReplacer.replace(input));
+    }
+}
+
+BENCHMARK(replaceLoopBench)->Unit(benchmark::kMillisecond);
+BENCHMARK(replaceBench)->Unit(benchmark::kMillisecond);
+BENCHMARK(dos2unixBench)->Unit(benchmark::kMillisecond);
+BENCHMARK(replaceManyPatternsLoopBench)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK(replaceAllBench)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
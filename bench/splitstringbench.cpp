@@ -1,6 +1,9 @@
+#include "utils/stringoperations.h"
+
 #include <benchmark/benchmark.h>
 #include <iostream>
 #include <numeric>
+#include <random>
 
 #include <boost/algorithm/string.hpp>
 
@@ -248,9 +251,104 @@ static void splitBoostBench(benchmark::State& state)
     }
 }
 
+// Comma separated input of about 64KB, the token lengths are uniformly distributed in [minLength, maxLength]
+static std::string createSplitInput(int minLength, int maxLength)
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> lengthDist(minLength, maxLength);
+
+    std::string input;
+    while (input.size() < 64 * 1024)
+    {
+        input.append(lengthDist(rng), 'x');
+        input += ',';
+    }
+
+    return input;
+}
+
+static void splittedViewFindTokenLengthBench(benchmark::State& state)
+{
+    auto input = createSplitInput(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(splittedView(input, ','));
+    }
+
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static void utilsSplittedViewTokenLengthBench(benchmark::State& state)
+{
+    auto input = createSplitInput(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(utils::str::splitted_view(input, ','));
+    }
+
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static void utilsSplittedViewTrimTokenLengthBench(benchmark::State& state)
+{
+    auto input = createSplitInput(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(utils::str::splitted_view(input, ',', utils::str::split_opt::trim));
+    }
+
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static void utilsSplitRangeTokenLengthBench(benchmark::State& state)
+{
+    auto input = createSplitInput(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (auto token : utils::str::split_range(input, ','))
+        {
+            benchmark::DoNotOptimize(token);
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static void utilsSplitRangeThirdFieldBench(benchmark::State& state)
+{
+    std::string input = "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15";
+
+    for (auto _ : state)
+    {
+        auto range = utils::str::split_range(input, ',');
+        auto field = *std::next(range.begin(), 2);
+        if (field != "3")
+        {
+            throw std::runtime_error("error");
+        }
+    }
+}
+
+static void tokenLengthArguments(benchmark::internal::Benchmark* b)
+{
+    b->Args({1, 1})->Args({4, 4})->Args({16, 16})->Args({64, 64})->Args({256, 256})->Args({0, 32})->Args({1, 512});
+}
+
 BENCHMARK(splitBench);
 BENCHMARK(splittedViewBench);
 BENCHMARK(splittedViewLoopBench);
 BENCHMARK(splittedViewStringDelimeterBench);
 BENCHMARK(splittedViewLoopStringDelimeterBench);
 BENCHMARK(splitBoostBench);
+BENCHMARK(splittedViewFindTokenLengthBench)->Apply(tokenLengthArguments);
+BENCHMARK(utilsSplittedViewTokenLengthBench)->Apply(tokenLengthArguments);
+BENCHMARK(utilsSplittedViewTrimTokenLengthBench)->Apply(tokenLengthArguments);
+BENCHMARK(utilsSplitRangeTokenLengthBench)->Apply(tokenLengthArguments);
+BENCHMARK(utilsSplitRangeThirdFieldBench);
@@ -0,0 +1,73 @@
+#include "utils/timeoperations.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace utils;
+
+static void getTimeStringBench(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(timeops::getTimeString());
+    }
+}
+
+static void formatTimeBench(benchmark::State& state)
+{
+    char buffer[16];
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(timeops::formatTime(std::chrono::system_clock::now(), buffer));
+        benchmark::ClobberMemory();
+    }
+}
+
+static void formatTimeCoarseClockBench(benchmark::State& state)
+{
+    char buffer[16];
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(timeops::formatTime(timeops::coarse_system_clock::now(), buffer));
+        benchmark::ClobberMemory();
+    }
+}
+
+static void systemClockBench(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::chrono::system_clock::now());
+    }
+}
+
+static void coarseSystemClockBench(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(timeops::coarse_system_clock::now());
+    }
+}
+
+static void steadyClockBench(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+    }
+}
+
+static void coarseSteadyClockBench(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(timeops::coarse_steady_clock::now());
+    }
+}
+
+BENCHMARK(getTimeStringBench);
+BENCHMARK(formatTimeBench);
+BENCHMARK(formatTimeCoarseClockBench);
+BENCHMARK(systemClockBench);
+BENCHMARK(coarseSystemClockBench);
+BENCHMARK(steadyClockBench);
+BENCHMARK(coarseSteadyClockBench);
@@ -44,9 +44,91 @@ static void trimInPlaceUseAssignNoTrim(benchmark::State& state)
     }
 }
 
+// The find_first_not_of based implementation that was used before the vectorized trim
+static std::string_view trimmedViewFind(std::string_view str)
+{
+    auto begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+
+    auto end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, (end + 1) - begin);
+}
+
+static std::string createPadded(size_t padding)
+{
+    std::string str;
+    for (size_t i = 0; i < padding; ++i)
+    {
+        str += " \t"[i % 2];
+    }
+
+    str += "please trim me";
+    str += std::string(padding, ' ');
+    return str;
+}
+
+static void trimmedViewFindLongPadding(benchmark::State& state)
+{
+    auto str = createPadded(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(trimmedViewFind(str));
+    }
+}
+
+static void trimmedViewLongPadding(benchmark::State& state)
+{
+    auto str = createPadded(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(trimmed_view(str));
+    }
+}
+
+static std::vector<std::string_view> createShortTokens(std::string& storage)
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        storage += (i % 3 == 0) ? " field " : (i % 3 == 1) ? "value" : "\t42 ";
+        storage += ',';
+    }
+
+    return splitted_view(storage, ',');
+}
+
+static void trimmedViewFindShortTokens(benchmark::State& state)
+{
+    std::string storage;
+    auto tokens = createShortTokens(storage);
+    auto trimmed = tokens;
+    for (auto _ : state) {
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            trimmed[i] = trimmedViewFind(tokens[i]);
+        }
+        benchmark::DoNotOptimize(trimmed.data());
+    }
+}
+
+static void trimAllShortTokens(benchmark::State& state)
+{
+    std::string storage;
+    auto tokens = createShortTokens(storage);
+    auto trimmed = tokens;
+    for (auto _ : state) {
+        std::copy(tokens.begin(), tokens.end(), trimmed.begin());
+        trim_all(trimmed);
+        benchmark::DoNotOptimize(trimmed.data());
+    }
+}
+
 BENCHMARK(trimInPlaceCreateNew);
 BENCHMARK(trimInPlaceUseAssign);
 BENCHMARK(trimInPlaceCreateNewNoTrim);
 BENCHMARK(trimInPlaceUseAssignNoTrim);
+BENCHMARK(trimmedViewFindLongPadding)->Arg(4)->Arg(64)->Arg(1024);
+BENCHMARK(trimmedViewLongPadding)->Arg(4)->Arg(64)->Arg(1024);
+BENCHMARK(trimmedViewFindShortTokens);
+BENCHMARK(trimAllShortTokens);
 
-BENCHMARK_MAIN()
+BENCHMARK_MAIN();
@@ -0,0 +1,106 @@
+#include "utils/stringoperations.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+
+using namespace utils::str;
+
+// The stringstream based implementation that was used before the table driven encoder
+static std::string urlEncodeStream(const std::string& aString)
+{
+    std::stringstream result;
+
+    for (size_t i = 0; i < aString.size(); ++i)
+    {
+        int curChar = static_cast<int>(static_cast<unsigned char>(aString[i]));
+        if ((curChar >= 48 && curChar <= 57) ||
+            (curChar >= 65 && curChar <= 90) ||
+            (curChar >= 97 && curChar <= 122) ||
+            aString[i] == '-' || aString[i] == '_' ||
+            aString[i] == '.' || aString[i] == '!' ||
+            aString[i] == '~' || aString[i] == '*' ||
+            aString[i] == '\'' || aString[i] == '(' ||
+            aString[i] == ')')
+        {
+            result << aString[i];
+        }
+        else if (aString[i] == ' ')
+        {
+            result << '+';
+        }
+        else
+        {
+            result << '%' << std::hex << curChar;
+        }
+    }
+
+    return result.str();
+}
+
+// Query string of key=value pairs with spaces, punctuation and some UTF-8
+static std::string createQueryString(size_t size)
+{
+    static const std::vector<std::string> words = {"search", "query", "hello world", "a&b", "x=y", "Trentem\xC3\xB8ller", "50%", "path/to/file", "~user"};
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> wordDist(0, words.size() - 1);
+
+    std::string result;
+    while (result.size() < size)
+    {
+        result += words[wordDist(rng)];
+        result += '=';
+        result += words[wordDist(rng)];
+        result += '&';
+    }
+
+    return result;
+}
+
+static void urlEncodeStreamBench(benchmark::State& state)
+{
+    auto input = createQueryString(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(urlEncodeStream(input));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(input.size()));
+}
+
+static void urlEncodeBench(benchmark::State& state)
+{
+    auto input = createQueryString(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(urlEncode(input));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(input.size()));
+}
+
+static void urlEncodeBufferBench(benchmark::State& state)
+{
+    auto input = createQueryString(static_cast<size_t>(state.range(0)));
+    std::vector<char> buffer(urlEncodedSize(input));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(urlEncode(input, buffer.data()));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(input.size()));
+}
+
+static void urlDecodeBench(benchmark::State& state)
+{
+    auto input = urlEncode(createQueryString(static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(urlDecode(input));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(input.size()));
+}
+
+BENCHMARK(urlEncodeStreamBench)->Arg(64)->Arg(4096)->Arg(64 * 1024);
+BENCHMARK(urlEncodeBench)->Arg(64)->Arg(4096)->Arg(64 * 1024);
+BENCHMARK(urlEncodeBufferBench)->Arg(64)->Arg(4096)->Arg(64 * 1024);
+BENCHMARK(urlDecodeBench)->Arg(64)->Arg(4096)->Arg(64 * 1024);
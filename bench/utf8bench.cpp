@@ -0,0 +1,90 @@
+#include "utils/utf8.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace utils::str;
+
+// ~4MB of text, the argument is the percentage of multi-byte characters
+static std::string createText(int multiBytePercentage)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> percentDist(0, 99);
+    std::uniform_int_distribution<int> sequenceDist(0, 2);
+
+    std::string result;
+    while (result.size() < 4 * 1024 * 1024)
+    {
+        if (percentDist(rng) < multiBytePercentage)
+        {
+            switch (sequenceDist(rng))
+            {
+            case 0:  result += u8"é"; break;
+            case 1:  result += u8"中"; break;
+            default: result += u8"\U0001F600"; break;
+            }
+        }
+        else
+        {
+            result += char('a' + percentDist(rng) % 26);
+        }
+    }
+
+    return result;
+}
+
+static void validateUtf8Bench(benchmark::State& state)
+{
+    auto text = createText(int(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_valid_utf8(text));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+static void utf8LengthBench(benchmark::State& state)
+{
+    auto text = createText(int(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utf8_length(text));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+static void utf8ToUtf16Bench(benchmark::State& state)
+{
+    auto text = createText(int(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utf8_to_utf16(text));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+static void utf8ToUtf32Bench(benchmark::State& state)
+{
+    auto text = createText(int(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utf8_to_utf32(text));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+static void utf16ToUtf8Bench(benchmark::State& state)
+{
+    auto text = utf8_to_utf16(createText(int(state.range(0))));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utf16_to_utf8(text));
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size() * sizeof(char16_t)));
+}
+
+BENCHMARK(validateUtf8Bench)->Arg(0)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(utf8LengthBench)->Arg(0)->Arg(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(utf8ToUtf16Bench)->Arg(0)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(utf8ToUtf32Bench)->Arg(0)->Arg(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(utf16ToUtf8Bench)->Arg(0)->Arg(100)->Unit(benchmark::kMicrosecond);
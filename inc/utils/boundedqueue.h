@@ -0,0 +1,159 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace utils
+{
+
+// Bounded lock-free queue that supports multiple producers and multiple consumers
+// Every slot carries a sequence number that tells producers and consumers whether
+// it is free to be written or ready to be read, so no locks are needed.
+// The capacity is rounded up to the next power of two.
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+    : m_capacity(roundUpToPowerOfTwo(capacity))
+    , m_mask(m_capacity - 1)
+    , m_cells(std::make_unique<Cell[]>(m_capacity))
+    {
+        for (size_t i = 0; i < m_capacity; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Returns false when the queue is full, value is left untouched in that case
+    bool tryPush(T&& value) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        Cell* cell = nullptr;
+        auto  pos  = m_enqueuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell      = &m_cells[pos & m_mask];
+            auto seq  = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the queue is empty
+    bool tryPop(T& value) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        Cell* cell = nullptr;
+        auto  pos  = m_dequeuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell      = &m_cells[pos & m_mask];
+            auto seq  = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(pos + m_capacity, std::memory_order_release);
+        return true;
+    }
+
+    // Only a snapshot, the result can be outdated as soon as it is returned
+    bool empty() const noexcept
+    {
+        auto pos = m_dequeuePos.load(std::memory_order_acquire);
+        return m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) noexcept
+    {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T                   value;
+    };
+
+    static constexpr size_t CacheLineSize = 64;
+
+    const size_t            m_capacity;
+    const size_t            m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    alignas(CacheLineSize) std::atomic<size_t> m_enqueuePos{0};
+    alignas(CacheLineSize) std::atomic<size_t> m_dequeuePos{0};
+};
+
+}
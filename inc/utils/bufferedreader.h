@@ -27,11 +27,16 @@ namespace utils
 {
 
 // Buffered reader should be used when lots of small io reads are done
+// With read ahead buffers the blocks that follow the buffer are read on a background thread
+// while the current buffer is consumed (1 = double buffering, 2 = triple buffering).
+// The number of blocks that is read ahead grows with each sequential buffer refill up to
+// the number of read ahead buffers and drops to zero when seeking outside of the buffered data.
 
 class BufferedReader : public IReader
 {
 public:
-    BufferedReader(std::unique_ptr<IReader> reader, size_t bufferSize);
+    BufferedReader(std::unique_ptr<IReader> reader, size_t bufferSize, uint32_t readAheadBuffers = 0);
+    ~BufferedReader() override;
 
     void open(const std::string& filename) override;
     void close() override;
@@ -47,16 +52,26 @@ public:
     std::vector<uint8_t> readAllData() override;
     void clearErrors() override;
 
+    // Returns the data from the buffer, peeks larger than the buffer are passed to the wrapped reader
+    ByteSpan peek(uint64_t size) override;
+
 private:
-    void updateOffsetsAfterSeek(uint64_t newPosition);
+    class ReadAhead;
+
+    bool bufferContains(uint64_t position) const noexcept;
+    bool refillBuffer();
+    void cancelReadAhead();
 
     std::unique_ptr<IReader> m_reader;
     std::vector<uint8_t> m_buffer;
+    std::vector<uint8_t> m_spanBuffer;
     uint64_t m_bufferStartPosition;
-    uint64_t m_bufferOffset;
+    uint64_t m_bufferLength;
     uint64_t m_currentPosition;
     uint64_t m_contentLength;
-    bool m_bufferFilled;
+    uint32_t m_readAheadBuffers;
+    uint32_t m_sequentialRefills;
+    std::unique_ptr<ReadAhead> m_readAhead;
 };
 }
 
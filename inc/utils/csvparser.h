@@ -0,0 +1,119 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils
+{
+
+class IReader;
+
+namespace str
+{
+
+struct csv_options
+{
+    char delimiter = ',';
+    char quote     = '"';
+    // When disabled quotes are regular characters, e.g. for TSV files
+    bool quoting = true;
+    // Number of bytes requested from the reader at once
+    size_t chunkSize = 64 * 1024;
+};
+
+// Streaming RFC 4180 CSV/TSV parser, e.g.:
+//   csv_parser parser(reader, csv_options{'\t'});
+//   while (parser.read_row())
+//   {
+//       for (auto field : parser.fields()) { ... }
+//   }
+//
+// The fields point into the internal buffer (or the provided data) and remain valid
+// until the next call to read_row. Data is only copied when a row spans a chunk
+// boundary or when a quoted field contains escaped quotes ("" becomes ").
+// Rows end with \n, \r\n or \r, empty lines are skipped.
+// Characters between a closing quote and the next delimiter are appended to the field.
+class csv_parser
+{
+public:
+    // Parse the data read from reader, the reader must outlive the parser
+    explicit csv_parser(IReader& reader, csv_options options = csv_options());
+
+    // Parse data that is already in memory, the data must outlive the parser
+    explicit csv_parser(std::string_view data, csv_options options = csv_options());
+
+    // Parses the next row, returns false when there are no more rows
+    bool read_row();
+
+    // The fields of the last row that was read
+    const std::vector<std::string_view>& fields() const noexcept
+    {
+        return m_fields;
+    }
+
+    // Number of rows that were read
+    uint64_t row_count() const noexcept
+    {
+        return m_rowCount;
+    }
+
+private:
+    enum class ParseResult
+    {
+        Row,
+        NeedMoreData,
+        End
+    };
+
+    // field that is stored in m_unescaped instead of the input data
+    struct UnescapedField
+    {
+        size_t index;
+        size_t offset;
+        size_t size;
+    };
+
+    ParseResult parseRow();
+    bool refill();
+    size_t nextStructural(size_t pos, size_t& maskBase, uint64_t& mask) const noexcept;
+    uint64_t structuralMask(size_t pos) const noexcept;
+
+    IReader*                        m_reader = nullptr;
+    csv_options                     m_options;
+    std::vector<char>               m_buffer;
+    const char*                     m_data = nullptr;
+    size_t                          m_size = 0;
+    size_t                          m_pos  = 0;
+    bool                            m_eof  = false;
+
+    // bit mask of the delimiters, quotes and newlines of the block starting at m_maskBase
+    size_t                          m_maskBase = SIZE_MAX;
+    uint64_t                        m_mask     = 0;
+    uint64_t                        (*m_equalAnyMask)(const char*, char, char, char, char) noexcept;
+
+    std::vector<UnescapedField>     m_unescapedFields;
+    std::string                     m_unescaped;
+    std::vector<std::string_view>   m_fields;
+    uint64_t                        m_rowCount = 0;
+};
+
+}
+}
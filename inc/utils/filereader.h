@@ -42,9 +42,17 @@ public:
     std::vector<uint8_t> readAllData() override;
     void clearErrors() override;
 
+    // Reads ahead into a window so consecutive small peeks do not each access the file
+    ByteSpan peek(uint64_t size) override;
+
 private:
-    std::string         m_fileName;
-    std::ifstream       m_file;
+    std::string             m_fileName;
+    std::ifstream           m_file;
+    std::vector<uint8_t>    m_window;
+    uint64_t                m_windowPosition = 0;
+    uint64_t                m_windowSize = 0;
+    // the window contains the end of the file
+    bool                    m_windowAtEnd = false;
 };
 
 }
@@ -0,0 +1,392 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include "utils/stringoperations.h"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace utils
+{
+
+template <size_t N>
+class fixed_string;
+
+template <typename T>
+struct is_fixed_string : std::false_type
+{
+};
+
+template <size_t N>
+struct is_fixed_string<fixed_string<N>> : std::true_type
+{
+};
+
+// String of at most N characters that is stored inline and never allocates, e.g. for short keys
+// and formatted numbers that do not fit in the small string buffer of std::string (15 characters
+// in libstdc++). The characters are always zero terminated.
+// Operations that would exceed the capacity throw std::length_error.
+template <size_t N>
+class fixed_string
+{
+public:
+    using value_type      = char;
+    using size_type       = size_t;
+    using traits_type     = std::char_traits<char>;
+    using iterator        = char*;
+    using const_iterator  = const char*;
+    using reference       = char&;
+    using const_reference = const char&;
+
+    static constexpr size_t npos = std::string_view::npos;
+
+    fixed_string() noexcept
+    {
+        m_data[0] = '\0';
+    }
+
+    fixed_string(const char* str)
+    {
+        assign(std::string_view(str));
+    }
+
+    explicit fixed_string(std::string_view str)
+    {
+        assign(str);
+    }
+
+    fixed_string(size_t count, char c)
+    {
+        assign(count, c);
+    }
+
+    fixed_string(const fixed_string& other) noexcept
+    {
+        std::memcpy(m_data, other.m_data, other.m_size + 1);
+        m_size = other.m_size;
+    }
+
+    fixed_string& operator=(const fixed_string& other) noexcept
+    {
+        std::memcpy(m_data, other.m_data, other.m_size + 1);
+        m_size = other.m_size;
+        return *this;
+    }
+
+    fixed_string& operator=(std::string_view str)
+    {
+        return assign(str);
+    }
+
+    fixed_string& operator=(const char* str)
+    {
+        return assign(std::string_view(str));
+    }
+
+    // str can point into this string
+    fixed_string& assign(std::string_view str)
+    {
+        checkCapacity(str.size());
+        std::memmove(m_data, str.data(), str.size());
+        setSize(str.size());
+        return *this;
+    }
+
+    fixed_string& assign(size_t count, char c)
+    {
+        checkCapacity(count);
+        std::memset(m_data, c, count);
+        setSize(count);
+        return *this;
+    }
+
+    fixed_string& append(std::string_view str)
+    {
+        checkCapacity(m_size + str.size());
+        std::memcpy(m_data + m_size, str.data(), str.size());
+        setSize(m_size + str.size());
+        return *this;
+    }
+
+    fixed_string& append(const char* str, size_t count)
+    {
+        return append(std::string_view(str, count));
+    }
+
+    fixed_string& append(const char* first, const char* last)
+    {
+        return append(std::string_view(first, static_cast<size_t>(last - first)));
+    }
+
+    fixed_string& append(size_t count, char c)
+    {
+        checkCapacity(m_size + count);
+        std::memset(m_data + m_size, c, count);
+        setSize(m_size + count);
+        return *this;
+    }
+
+    fixed_string& operator+=(std::string_view str)
+    {
+        return append(str);
+    }
+
+    fixed_string& operator+=(char c)
+    {
+        push_back(c);
+        return *this;
+    }
+
+    void push_back(char c)
+    {
+        checkCapacity(m_size + 1u);
+        m_data[m_size] = c;
+        setSize(m_size + 1u);
+    }
+
+    void pop_back() noexcept
+    {
+        setSize(m_size - 1u);
+    }
+
+    void resize(size_t size, char c = '\0')
+    {
+        checkCapacity(size);
+        if (size > m_size)
+        {
+            std::memset(m_data + m_size, c, size - m_size);
+        }
+
+        setSize(size);
+    }
+
+    // Only checks the capacity, e.g. when used as join_into output
+    void reserve(size_t size) const
+    {
+        checkCapacity(size);
+    }
+
+    void clear() noexcept
+    {
+        setSize(0);
+    }
+
+    char* data() noexcept { return m_data; }
+    const char* data() const noexcept { return m_data; }
+    const char* c_str() const noexcept { return m_data; }
+
+    size_t size() const noexcept { return m_size; }
+    size_t length() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    static constexpr size_t capacity() noexcept { return N; }
+    static constexpr size_t max_size() noexcept { return N; }
+
+    char& operator[](size_t index) noexcept { return m_data[index]; }
+    char operator[](size_t index) const noexcept { return m_data[index]; }
+    char& front() noexcept { return m_data[0]; }
+    char front() const noexcept { return m_data[0]; }
+    char& back() noexcept { return m_data[m_size - 1]; }
+    char back() const noexcept { return m_data[m_size - 1]; }
+
+    iterator begin() noexcept { return m_data; }
+    iterator end() noexcept { return m_data + m_size; }
+    const_iterator begin() const noexcept { return m_data; }
+    const_iterator end() const noexcept { return m_data + m_size; }
+    const_iterator cbegin() const noexcept { return m_data; }
+    const_iterator cend() const noexcept { return m_data + m_size; }
+
+    std::string_view view() const noexcept
+    {
+        return std::string_view(m_data, m_size);
+    }
+
+    operator std::string_view() const noexcept
+    {
+        return view();
+    }
+
+    std::string str() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+    // The comparisons accept everything that converts to string_view, the templates avoid the
+    // ambiguity between converting the other operand to string_view or to a fixed_string
+    friend bool operator==(const fixed_string& lhs, const fixed_string& rhs) noexcept
+    {
+        return lhs.view() == rhs.view();
+    }
+
+    friend bool operator!=(const fixed_string& lhs, const fixed_string& rhs) noexcept
+    {
+        return lhs.view() != rhs.view();
+    }
+
+    friend bool operator<(const fixed_string& lhs, const fixed_string& rhs) noexcept
+    {
+        return lhs.view() < rhs.view();
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_convertible_v<const T&, std::string_view>>>
+    friend bool operator==(const fixed_string& lhs, const T& rhs) noexcept
+    {
+        return lhs.view() == std::string_view(rhs);
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_convertible_v<const T&, std::string_view> && !is_fixed_string<T>::value>>
+    friend bool operator==(const T& lhs, const fixed_string& rhs) noexcept
+    {
+        return std::string_view(lhs) == rhs.view();
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_convertible_v<const T&, std::string_view>>>
+    friend bool operator!=(const fixed_string& lhs, const T& rhs) noexcept
+    {
+        return lhs.view() != std::string_view(rhs);
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_convertible_v<const T&, std::string_view> && !is_fixed_string<T>::value>>
+    friend bool operator!=(const T& lhs, const fixed_string& rhs) noexcept
+    {
+        return std::string_view(lhs) != rhs.view();
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_convertible_v<const T&, std::string_view>>>
+    friend bool operator<(const fixed_string& lhs, const T& rhs) noexcept
+    {
+        return lhs.view() < std::string_view(rhs);
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_convertible_v<const T&, std::string_view> && !is_fixed_string<T>::value>>
+    friend bool operator<(const T& lhs, const fixed_string& rhs) noexcept
+    {
+        return std::string_view(lhs) < rhs.view();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const fixed_string& str)
+    {
+        return os << str.view();
+    }
+
+private:
+    // the smallest type that holds the size keeps fixed_string<31> at 33 bytes
+    using SizeType = std::conditional_t<N <= UINT8_MAX, uint8_t, std::conditional_t<N <= UINT16_MAX, uint16_t, size_t>>;
+
+    static void checkCapacity(size_t size)
+    {
+        if (size > N)
+        {
+            throw std::length_error("fixed_string capacity exceeded");
+        }
+    }
+
+    void setSize(size_t size) noexcept
+    {
+        m_size       = static_cast<SizeType>(size);
+        m_data[size] = '\0';
+    }
+
+    char m_data[N + 1];
+    SizeType m_size = 0;
+};
+
+namespace str
+{
+
+// fixed_string overloads of the string helpers, the results are returned as fixed_string
+// of the same capacity so they do not allocate either
+
+template <size_t N>
+void trim_in_place(fixed_string<N>& str, const char_set& chars = whitespace)
+{
+    auto trimmed = trimmed_view(str, chars);
+    if (trimmed.size() != str.size())
+    {
+        str.assign(trimmed);
+    }
+}
+
+template <size_t N>
+[[nodiscard]] fixed_string<N> trim(const fixed_string<N>& str, const char_set& chars = whitespace)
+{
+    return fixed_string<N>(trimmed_view(str, chars));
+}
+
+template <size_t N>
+void lowercase_in_place(fixed_string<N>& str) noexcept
+{
+    lowercase_into(str, str.data());
+}
+
+template <size_t N>
+void uppercase_in_place(fixed_string<N>& str) noexcept
+{
+    uppercase_into(str, str.data());
+}
+
+template <size_t N>
+[[nodiscard]] fixed_string<N> lowercase(const fixed_string<N>& str)
+{
+    fixed_string<N> result;
+    result.resize(str.size());
+    lowercase_into(str, result.data());
+    return result;
+}
+
+template <size_t N>
+[[nodiscard]] fixed_string<N> uppercase(const fixed_string<N>& str)
+{
+    fixed_string<N> result;
+    result.resize(str.size());
+    uppercase_into(str, result.data());
+    return result;
+}
+
+// toString variant that formats into a fixed_string of capacity N, e.g. toString<24>(id)
+// Throws std::length_error when the result does not fit
+template <size_t N, typename T>
+fixed_string<N> toString(const T& value)
+{
+    fixed_string<N> result;
+    detail::append_item(result, value);
+    return result;
+}
+
+}
+}
+
+namespace std
+{
+
+template <size_t N>
+struct hash<utils::fixed_string<N>>
+{
+    // equal to the hash of the same characters in an std::string
+    size_t operator()(const utils::fixed_string<N>& str) const noexcept
+    {
+        return std::hash<std::string_view>()(str.view());
+    }
+};
+
+}
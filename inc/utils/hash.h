@@ -0,0 +1,282 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include "utils/traits.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace utils
+{
+
+class IReader;
+
+// Fast non-cryptographic 64-bit hashing based on wyhash: the input is mixed 8 bytes at a time
+// with 64x64->128 bit multiplications, long inputs are processed in three independent lanes.
+// The results are stable across platforms and releases of the library, so they can be stored.
+namespace hash
+{
+
+namespace detail
+{
+
+inline constexpr uint64_t Secret[4] = {0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47};
+
+// 64x64 bit multiplication, a receives the low and b the high half of the product
+constexpr void multiply(uint64_t& a, uint64_t& b) noexcept
+{
+#ifdef __SIZEOF_INT128__
+    auto product = static_cast<unsigned __int128>(a) * b;
+    a            = static_cast<uint64_t>(product);
+    b            = static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t aHigh = a >> 32, aLow = a & 0xFFFFFFFF;
+    const uint64_t bHigh = b >> 32, bLow = b & 0xFFFFFFFF;
+    const uint64_t cross0 = aHigh * bLow;
+    const uint64_t cross1 = aLow * bHigh;
+
+    uint64_t low   = aLow * bLow;
+    uint64_t carry = 0;
+    low += cross0 << 32;
+    carry += low < (cross0 << 32);
+    low += cross1 << 32;
+    carry += low < (cross1 << 32);
+
+    b = aHigh * bHigh + (cross0 >> 32) + (cross1 >> 32) + carry;
+    a = low;
+#endif
+}
+
+constexpr uint64_t mix(uint64_t a, uint64_t b) noexcept
+{
+    multiply(a, b);
+    return a ^ b;
+}
+
+// The input is read as little endian so the hashes are the same on every platform,
+// the bytes are combined one by one during constant evaluation
+constexpr uint64_t read64(const char* data) noexcept
+{
+    if (is_constant_evaluated())
+    {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+        {
+            value = (value << 8) | static_cast<uint8_t>(data[i]);
+        }
+
+        return value;
+    }
+
+    uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+constexpr uint64_t read32(const char* data) noexcept
+{
+    if (is_constant_evaluated())
+    {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i)
+        {
+            value = (value << 8) | static_cast<uint8_t>(data[i]);
+        }
+
+        return value;
+    }
+
+    uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+constexpr uint64_t initialSeed(uint64_t seed) noexcept
+{
+    return seed ^ mix(seed ^ Secret[0], Secret[1]);
+}
+
+constexpr uint64_t finish(uint64_t a, uint64_t b, uint64_t seed, uint64_t size) noexcept
+{
+    a ^= Secret[1];
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ Secret[0] ^ size, b ^ Secret[1]);
+}
+
+// Inputs up to 16 bytes are read with overlapping loads instead of a loop
+constexpr uint64_t hashShort(const char* data, size_t size, uint64_t seed) noexcept
+{
+    uint64_t a = 0, b = 0;
+    if (size >= 4)
+    {
+        auto offset = (size >> 3) << 2;
+        a = (read32(data) << 32) | read32(data + offset);
+        b = (read32(data + size - 4) << 32) | read32(data + size - 4 - offset);
+    }
+    else if (size > 0)
+    {
+        a = (uint64_t(uint8_t(data[0])) << 16) | (uint64_t(uint8_t(data[size >> 1])) << 8) | uint8_t(data[size - 1]);
+    }
+
+    return finish(a, b, seed, size);
+}
+
+// The three lanes of a stripe do not depend on each other so the multiplications overlap
+constexpr void processStripe(const char* data, uint64_t& seed, uint64_t& lane1, uint64_t& lane2) noexcept
+{
+    seed  = mix(read64(data) ^ Secret[1], read64(data + 8) ^ seed);
+    lane1 = mix(read64(data + 16) ^ Secret[2], read64(data + 24) ^ lane1);
+    lane2 = mix(read64(data + 32) ^ Secret[3], read64(data + 40) ^ lane2);
+}
+
+// Hashes the last 1 to 48 bytes of an input that is longer than 16 bytes,
+// the 16 bytes before data + remaining must be readable
+constexpr uint64_t hashRemaining(const char* data, size_t remaining, uint64_t seed, uint64_t size) noexcept
+{
+    while (remaining > 16)
+    {
+        seed = mix(read64(data) ^ Secret[1], read64(data + 8) ^ seed);
+        data += 16;
+        remaining -= 16;
+    }
+
+    return finish(read64(data + remaining - 16), read64(data + remaining - 8), seed, size);
+}
+
+constexpr uint64_t hash64(const char* data, size_t size, uint64_t seed) noexcept
+{
+    seed = initialSeed(seed);
+    if (size <= 16)
+    {
+        return hashShort(data, size, seed);
+    }
+
+    auto remaining = size;
+    if (remaining > 48)
+    {
+        uint64_t lane1 = seed, lane2 = seed;
+        do
+        {
+            processStripe(data, seed, lane1, lane2);
+            data += 48;
+            remaining -= 48;
+        } while (remaining > 48);
+
+        seed ^= lane1 ^ lane2;
+    }
+
+    return hashRemaining(data, remaining, seed, size);
+}
+
+}
+
+// Note: hash64("literal", seed) selects the (data, size) overload, pass a string_view to provide a seed
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0) noexcept;
+
+// Can be evaluated at compile time, the result is the same as at runtime
+constexpr uint64_t hash64(std::string_view str, uint64_t seed = 0) noexcept
+{
+    return detail::hash64(str.data(), str.size(), seed);
+}
+
+// Hash of all the remaining data of the reader, equal to the hash of the data in one buffer
+uint64_t hash64(IReader& reader, uint64_t seed = 0);
+
+// Incremental hashing of data that is not available at once, the digest equals the
+// result of hash64 over the concatenation of all the updates, e.g.:
+//   Hasher hasher;
+//   while (auto size = readChunk(buffer)) { hasher.update(buffer, size); }
+//   auto hash = hasher.digest();
+class Hasher
+{
+public:
+    explicit Hasher(uint64_t seed = 0) noexcept;
+
+    void update(const void* data, size_t size) noexcept;
+
+    void update(std::string_view str) noexcept
+    {
+        update(str.data(), str.size());
+    }
+
+    // The hash of the data so far, more data can still be added afterwards
+    uint64_t digest() const noexcept;
+
+    void reset(uint64_t seed = 0) noexcept;
+
+private:
+    static constexpr size_t StripeSize  = 48;
+    static constexpr size_t HistorySize = 16;
+
+    uint64_t m_seed;
+    uint64_t m_lanes[2];
+    uint64_t m_size = 0;
+    // the last bytes of the previous stripe followed by the pending bytes, the final
+    // block of the hash can overlap with the previous stripe
+    std::array<char, HistorySize + StripeSize> m_buffer;
+    size_t m_pending = 0;
+};
+
+// Hash functor for unordered containers keyed by std::string, string_view or const char*
+// All of them hash the same characters to the same value, and the functors are transparent
+// so C++20 containers can find a std::string key from a string_view without a copy:
+//   std::unordered_map<std::string, int, hash::StringHash, hash::StringEqual> map;
+struct StringHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const noexcept
+    {
+        return static_cast<size_t>(hash64(str));
+    }
+};
+
+using StringEqual = std::equal_to<>;
+
+namespace literals
+{
+
+// Hash of a string literal at compile time, e.g. to switch on strings:
+//   using namespace utils::hash::literals;
+//   switch (hash64(method))
+//   {
+//   case "GET"_hash: ...
+//   case "PUT"_hash: ...
+//   }
+// Labels that collide do not compile, input that is not one of the labels can still collide
+// with one, so compare the string in the case when the input is not trusted
+constexpr uint64_t operator""_hash(const char* str, size_t size) noexcept
+{
+    return hash64(std::string_view(str, size));
+}
+
+}
+
+}
+}
@@ -17,19 +17,42 @@
 #ifndef UTILS_LOG_H
 #define UTILS_LOG_H
 
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <memory>
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "utils/format.h"
 #include "utils/timeoperations.h"
 
+// Messages below this level (0: Debug ... 4: Critical) are removed at compile time
+// Set it with the UTILS_LOG_MIN_LEVEL CMake variable, which defines it for the utils target and
+// everything that links to it. It must not differ between translation units of one program:
+// log::CompiledLevel and the inline log functions would have different definitions (ODR violation).
+#ifndef UTILS_LOG_MIN_LEVEL
+    #ifdef COMPILE_DEBUG_LOG
+        #define UTILS_LOG_MIN_LEVEL 0
+    #else
+        #define UTILS_LOG_MIN_LEVEL 1
+    #endif
+#endif
+
 namespace utils
 {
 
+class ILogSink;
+
 class log
 {
 public:
@@ -42,11 +65,156 @@ public:
         Critical
     };
 
+    // What to do when a message is logged while the asynchronous queue is full
+    enum class OverflowPolicy
+    {
+        Block,  // wait until the writer thread made room in the queue
+        Drop    // discard the message, the number of dropped messages is available in droppedMessages()
+    };
+
+    // Where the format arguments are turned into text when logging asynchronously
+    enum class FormatMode
+    {
+        Immediate,  // on the calling thread
+        Deferred    // on the writer thread, only the format string pointer and the raw argument
+                    // bytes are queued. Only used by the UTILS_LOG macros, which require a string
+                    // literal as format, when all arguments are arithmetic, enum or non string
+                    // pointer values. Other calls are formatted immediately.
+    };
+
+    // Marks a format string as a string literal, so it can be referred to after the log call returned
+    struct literal_format_t
+    {
+    };
+
+    static constexpr literal_format_t literal_format{};
+
+    static constexpr Level CompiledLevel = static_cast<Level>(UTILS_LOG_MIN_LEVEL);
+
+    // Named category of log messages that can be filtered separately, e.g.:
+    //   static const log::Module s_netLog("network");
+    //   UTILS_LOG_DEBUG_M(s_netLog, "Received {} bytes", size);
+    // Modules with the same name share their filter
+    class Module
+    {
+    public:
+        explicit Module(std::string_view name);
+
+        uint32_t id() const noexcept
+        {
+            return m_id;
+        }
+
+    private:
+        uint32_t m_id;
+    };
+
+    // Once all slots are taken new modules share slot 0, which always uses the global filter
+    static constexpr uint32_t MaxModules = 64;
+
     inline static void setFilter(Level level) noexcept
     {
-        m_level = level;
+        m_level.store(level, std::memory_order_relaxed);
+    }
+
+    // Filter for a single module, overrides the global filter
+    inline static void setFilter(const Module& module, Level level) noexcept
+    {
+        if (module.id() != 0)
+        {
+            m_moduleLevels[module.id()].store(static_cast<int>(level) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    // Filter for the module with the given name, also works before the module is created
+    static void setFilter(std::string_view moduleName, Level level);
+
+    // The module uses the global filter again
+    inline static void clearFilter(const Module& module) noexcept
+    {
+        m_moduleLevels[module.id()].store(0, std::memory_order_relaxed);
+    }
+
+    inline static bool isEnabled(Level level) noexcept
+    {
+        return level >= CompiledLevel && level >= m_level.load(std::memory_order_relaxed);
+    }
+
+    inline static bool isEnabled(const Module& module, Level level) noexcept
+    {
+        if (level < CompiledLevel)
+        {
+            return false;
+        }
+
+        auto moduleLevel = m_moduleLevels[module.id()].load(std::memory_order_relaxed);
+        return moduleLevel == 0 ? isEnabled(level) : static_cast<int>(level) + 1 >= moduleLevel;
+    }
+
+    // Logs without checking the filters, used by the UTILS_LOG macros that already did
+    template<typename... T>
+    inline static void emit(Level level, const char* s, T&&... args) noexcept
+    {
+        if constexpr (sizeof...(T) == 0)
+        {
+            write(level, s);
+        }
+        else
+        {
+            format(level, s, std::forward<T>(args)...);
+        }
+    }
+
+    // Logs a string literal format without checking the filters, only these calls can use deferred formatting
+    template<typename... T>
+    inline static void emit(Level level, literal_format_t, const char* s, T&&... args) noexcept
+    {
+        if constexpr (sizeof...(T) == 0)
+        {
+            write(level, s);
+        }
+        else
+        {
+            if constexpr ((is_deferrable_v<std::decay_t<T>> && ...) && (sizeof(std::decay_t<T>) + ... + 0) <= MaxDeferredArgsSize)
+            {
+                if (m_deferredFormatting.load(std::memory_order_relaxed))
+                {
+                    uint8_t data[MaxDeferredArgsSize];
+                    size_t  offset = 0;
+                    (writeArg<std::decay_t<T>>(data, offset, args), ...);
+                    writeDeferred(level, s, &formatDeferred<std::decay_t<T>...>, data, offset);
+                    return;
+                }
+            }
+
+            format(level, s, std::forward<T>(args)...);
+        }
+    }
+
+    // Timestamp messages using timeops::coarse_system_clock: cheaper, but only accurate to a few milliseconds
+    inline static void setCoarseTimestamps(bool enabled) noexcept
+    {
+        m_coarseTimestamps.store(enabled, std::memory_order_relaxed);
     }
 
+    // Once enabled, log calls only enqueue the message and return, a background thread
+    // takes care of the timestamp formatting and the actual printing.
+    // Not thread safe: call on startup before other threads start logging.
+    static void enableAsync(size_t queueCapacity = 8192,
+                            OverflowPolicy policy = OverflowPolicy::Block,
+                            FormatMode formatMode = FormatMode::Immediate);
+    // Prints all pending messages and stops the background thread.
+    // Not thread safe: call when other threads stopped logging.
+    static void disableAsync();
+    // Blocks until all messages that were logged before this call are printed
+    static void flush();
+    static uint64_t droppedMessages() noexcept;
+
+    // Every message is passed to all registered sinks, a ConsoleSink is registered by default
+    static void addSink(std::shared_ptr<ILogSink> sink);
+    static void removeSink(const std::shared_ptr<ILogSink>& sink);
+    static void clearSinks();
+
     inline static void info(const std::string& s) noexcept
     {
         info(s.c_str());
@@ -55,24 +223,17 @@ public:
     template<typename... T>
     inline static void info(const char* s, T&&... args) noexcept
     {
-        if (m_level <= Level::Info)
+        if (isEnabled(Level::Info))
         {
-            try
-            {
-                info(fmt::format(s, std::forward<const T>(args)...).c_str());
-            }
-            catch (fmt::FormatError&)
-            {
-                assert(false && "Formatting error");
-            }
+            format(Level::Info, s, std::forward<T>(args)...);
         }
     }
 
     inline static void info(const char* s) noexcept
     {
-        if (m_level <= Level::Info)
+        if (isEnabled(Level::Info))
         {
-            print_colored(fmt::GREEN, "INFO", s);
+            write(Level::Info, s);
         }
     }
 
@@ -84,24 +245,17 @@ public:
     template<typename... T>
     inline static void warn(const char* s, T&&... args) noexcept
     {
-        if (m_level <= Level::Warn)
+        if (isEnabled(Level::Warn))
         {
-            try
-            {
-                warn(fmt::format(s, std::forward<const T>(args)...).c_str());
-            }
-            catch (fmt::FormatError&)
-            {
-                assert(false && "Formatting error");
-            }
+            format(Level::Warn, s, std::forward<T>(args)...);
         }
     }
 
     inline static void warn(const char* s) noexcept
     {
-        if (m_level <= Level::Warn)
+        if (isEnabled(Level::Warn))
         {
-            print_colored(fmt::YELLOW, "WARN", s);
+            write(Level::Warn, s);
         }
     }
 
@@ -113,24 +267,17 @@ public:
     template<typename... T>
     inline static void critical(const char* s, T&&... args) noexcept
     {
-        if (m_level <= Level::Critical)
+        if (isEnabled(Level::Critical))
         {
-            try
-            {
-                critical(fmt::format(s, std::forward<const T>(args)...).c_str());
-            }
-            catch (fmt::FormatError&)
-            {
-                assert(false && "Formatting error");
-            }
+            format(Level::Critical, s, std::forward<T>(args)...);
         }
     }
 
     inline static void critical(const char* s) noexcept
     {
-        if (m_level <= Level::Critical)
+        if (isEnabled(Level::Critical))
         {
-            print_colored(fmt::MAGENTA, "CRIT", s);
+            write(Level::Critical, s);
         }
     }
 
@@ -142,24 +289,17 @@ public:
     template<typename... T>
     inline static void error(const char* s, T&&... args) noexcept
     {
-        if (m_level <= Level::Error)
+        if (isEnabled(Level::Error))
         {
-            try
-            {
-                error(fmt::format(s, std::forward<const T>(args)...).c_str());
-            }
-            catch (fmt::FormatError&)
-            {
-                assert(false && "Formatting error");
-            }
+            format(Level::Error, s, std::forward<T>(args)...);
         }
     }
 
     inline static void error(const char* s) noexcept
     {
-        if (m_level <= Level::Error)
+        if (isEnabled(Level::Error))
         {
-            print_colored(fmt::RED, "ERROR", s);
+            write(Level::Error, s);
         }
     }
 
@@ -172,16 +312,9 @@ public:
     template<typename... T>
     inline static void debug(const char* s, T&&... args) noexcept
     {
-        if (m_level == Level::Debug)
+        if (isEnabled(Level::Debug))
         {
-            try
-            {
-                debug(fmt::format(s, std::forward<const T>(args)...).c_str());
-            }
-            catch (fmt::FormatError&)
-            {
-                assert(false && "Formatting error");
-            }
+            format(Level::Debug, s, std::forward<T>(args)...);
         }
     }
 #else
@@ -194,16 +327,9 @@ public:
 #ifdef COMPILE_DEBUG_LOG
     inline static void debug(const char* s) noexcept
     {
-        if (m_level == Level::Debug)
+        if (isEnabled(Level::Debug))
         {
-            try
-            {
-                fmt::print_colored(fmt::WHITE, "DEBUG: [{}] [{}] {}\n", std::this_thread::get_id(), timeops::getTimeString(), s);
-            }
-            catch (const fmt::FormatError&)
-            {
-                assert(false && "Format error");
-            }
+            write(Level::Debug, s);
         }
     }
 #else
@@ -212,23 +338,96 @@ public:
     }
 #endif
 
+    // Maximum size of the raw argument bytes of a deferred format call
+    static constexpr size_t MaxDeferredArgsSize = 64;
+    using DeferredFormatter = std::string (*)(const char* format, const uint8_t* args);
+
 private:
-    inline static void print_colored(fmt::Color c, const char* level, const char* s) noexcept
+    class AsyncWriter;
+    struct Record;
+
+    template <typename T>
+    static constexpr bool is_deferrable_v = std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+        (std::is_pointer_v<T> && !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>);
+
+    template<typename... T>
+    inline static void format(Level level, const char* s, T&&... args) noexcept
     {
         try
         {
-            fmt::print_colored(c, "{}: [{}] {}\n", level, timeops::getTimeString(), s);
+            write(level, fmt::format(s, std::forward<const T>(args)...));
         }
-        catch (const fmt::FormatError&)
+        catch (fmt::FormatError&)
         {
-            assert(false && "Format error");
+            assert(false && "Formatting error");
         }
     }
 
-    static Level            m_level;
-    static std::mutex       m_mutex;
+    template <typename T>
+    inline static void writeArg(uint8_t* data, size_t& offset, const T& arg) noexcept
+    {
+        std::memcpy(data + offset, &arg, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    template <typename T>
+    inline static T readArg(const uint8_t* data, size_t& offset) noexcept
+    {
+        T arg;
+        std::memcpy(&arg, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return arg;
+    }
+
+    // Called on the writer thread to format the arguments stored by format()
+    template <typename... T>
+    static std::string formatDeferred(const char* s, const uint8_t* data)
+    {
+        size_t offset = 0;
+        // braced initialization guarantees the arguments are read in order
+        std::tuple<T...> args{readArg<T>(data, offset)...};
+        return std::apply([s] (const auto&... arg) { return fmt::format(s, arg...); }, args);
+    }
+
+    static void dispatch(Record& record) noexcept;
+    static void flushSinks() noexcept;
+    static void write(Level level, const char* s) noexcept;
+    static void write(Level level, std::string&& s) noexcept;
+    // s must be a string literal, only the pointer is queued
+    static void writeDeferred(Level level, const char* s, DeferredFormatter formatter, const uint8_t* args, size_t size) noexcept;
+
+    static std::atomic<Level>               m_level;
+    // 0: use the global level, otherwise the level + 1
+    static std::array<std::atomic<int>, MaxModules> m_moduleLevels;
+    static std::atomic<bool>                m_deferredFormatting;
+    static std::atomic<bool>                m_coarseTimestamps;
+    static std::mutex                       m_mutex;
+    static std::vector<std::shared_ptr<ILogSink>> m_sinks;
+    static std::unique_ptr<AsyncWriter>     m_asyncWriter;
 };
 
 }
 
+// The arguments are only evaluated when the message passes the filters,
+// messages below UTILS_LOG_MIN_LEVEL are compiled out completely
+// The format must be a string literal (the "" prefix rejects anything else at compile time),
+// use the log::info(...) functions for runtime format strings
+#define UTILS_LOG_IMPL(level, ...) \
+    do { if (utils::log::isEnabled(level)) { utils::log::emit(level, utils::log::literal_format, "" __VA_ARGS__); } } while (false)
+
+#define UTILS_LOG_MODULE_IMPL(module, level, ...) \
+    do { if (utils::log::isEnabled(module, level)) { utils::log::emit(level, utils::log::literal_format, "" __VA_ARGS__); } } while (false)
+
+#define UTILS_LOG_DEBUG(...)            UTILS_LOG_IMPL(utils::log::Level::Debug, __VA_ARGS__)
+#define UTILS_LOG_INFO(...)             UTILS_LOG_IMPL(utils::log::Level::Info, __VA_ARGS__)
+#define UTILS_LOG_WARN(...)             UTILS_LOG_IMPL(utils::log::Level::Warn, __VA_ARGS__)
+#define UTILS_LOG_ERROR(...)            UTILS_LOG_IMPL(utils::log::Level::Error, __VA_ARGS__)
+#define UTILS_LOG_CRITICAL(...)         UTILS_LOG_IMPL(utils::log::Level::Critical, __VA_ARGS__)
+
+#define UTILS_LOG_DEBUG_M(module, ...)      UTILS_LOG_MODULE_IMPL(module, utils::log::Level::Debug, __VA_ARGS__)
+#define UTILS_LOG_INFO_M(module, ...)       UTILS_LOG_MODULE_IMPL(module, utils::log::Level::Info, __VA_ARGS__)
+#define UTILS_LOG_WARN_M(module, ...)       UTILS_LOG_MODULE_IMPL(module, utils::log::Level::Warn, __VA_ARGS__)
+#define UTILS_LOG_ERROR_M(module, ...)      UTILS_LOG_MODULE_IMPL(module, utils::log::Level::Error, __VA_ARGS__)
+#define UTILS_LOG_CRITICAL_M(module, ...)   UTILS_LOG_MODULE_IMPL(module, utils::log::Level::Critical, __VA_ARGS__)
+
 #endif
@@ -0,0 +1,149 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#pragma once
+
+#include "utils/log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+
+struct LogMessage
+{
+    log::Level                              level;
+    std::chrono::system_clock::time_point   timestamp;
+    std::thread::id                         threadId;
+    std::string_view                        message;
+};
+
+// Destination of log messages, register it with log::addSink
+// Calls are serialized by the logger, sinks do not need to be thread safe themselves
+class ILogSink
+{
+public:
+    virtual ~ILogSink() = default;
+
+    virtual void write(const LogMessage& msg) = 0;
+    virtual void flush() = 0;
+};
+
+// Formats the message the way it is printed on the console, without trailing newline
+// e.g.: "WARN: [12:34:56.789] message"
+std::string formatLogMessage(const LogMessage& msg);
+
+// Colored output on stdout, this is the sink that is installed by default
+class ConsoleSink : public ILogSink
+{
+public:
+    void write(const LogMessage& msg) override;
+    void flush() override;
+};
+
+// Writes to a file and moves it out of the way when it gets too big or too old:
+// the active file is renamed to path.1, path.1 to path.2, ... and path.<maxFiles> is deleted
+class RotatingFileSink : public ILogSink
+{
+public:
+    // maxFileSize: rotate when the file exceeds this size in bytes, 0 disables size based rotation
+    // rotationInterval: rotate when the file has been open longer, 0 disables time based rotation
+    // maxFiles: number of rotated files that are kept
+    RotatingFileSink(const std::string& path,
+                     uint64_t maxFileSize,
+                     std::chrono::seconds rotationInterval = std::chrono::seconds(0),
+                     uint32_t maxFiles = 5);
+    ~RotatingFileSink();
+
+    RotatingFileSink(const RotatingFileSink&) = delete;
+    RotatingFileSink& operator=(const RotatingFileSink&) = delete;
+
+    // Force the written data to disk (fsync) at most once per interval, checked on every write and flush,
+    // 0 disables syncing (default). Error and critical messages are always flushed to the file immediately.
+    void setSyncInterval(std::chrono::milliseconds interval);
+
+    void write(const LogMessage& msg) override;
+    void flush() override;
+
+private:
+    void open();
+    void close();
+    void rotate();
+    bool reopen();
+    void sync();
+    void syncIfDue();
+
+    std::string                             m_path;
+    uint64_t                                m_maxFileSize;
+    std::chrono::seconds                    m_rotationInterval;
+    uint32_t                                m_maxFiles;
+    std::chrono::milliseconds               m_syncInterval;
+
+    std::FILE*                              m_file;
+    std::vector<char>                       m_fileBuffer;
+    uint64_t                                m_fileSize;
+    std::chrono::steady_clock::time_point   m_openTime;
+    std::chrono::steady_clock::time_point   m_lastSync;
+    std::chrono::steady_clock::time_point   m_failedOpenTime;
+    bool                                    m_unsyncedData;
+    std::string                             m_line;
+};
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+// Forwards the messages to syslog, the timestamp is added by the syslog daemon
+class SyslogSink : public ILogSink
+{
+public:
+    // ident is prepended to every message, it is copied as openlog keeps a pointer to it
+    explicit SyslogSink(const std::string& ident);
+    ~SyslogSink();
+
+    void write(const LogMessage& msg) override;
+    void flush() override;
+
+private:
+    std::string     m_ident;
+};
+#endif
+
+// Keeps the last messages in memory, e.g. to attach them to a crash report
+class RingBufferSink : public ILogSink
+{
+public:
+    explicit RingBufferSink(size_t capacity);
+
+    void write(const LogMessage& msg) override;
+    void flush() override;
+
+    // The stored messages, oldest first
+    std::vector<std::string> messages() const;
+    void clear();
+
+private:
+    size_t                  m_capacity;
+    mutable std::mutex      m_mutex;
+    std::deque<std::string> m_messages;
+};
+
+}
@@ -0,0 +1,88 @@
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef UTILS_MMAP_READER_H
+#define UTILS_MMAP_READER_H
+
+#include <string>
+
+#include "utils/readerinterface.h"
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+
+namespace utils
+{
+
+// Expected access pattern of a mapping, passed to the kernel as madvise hint
+enum class AccessPattern
+{
+    Normal,
+    Sequential,
+    Random,
+    WillNeed
+};
+
+// Reader that maps the complete file in memory (POSIX only)
+// read() copies from the mapping, span() and data() give access to the mapped
+// bytes without copying. The returned spans remain valid until the reader is closed.
+// Truncating the file while it is mapped makes accesses past the new end raise SIGBUS,
+// so only use it for files that are not modified while they are being read.
+class MmapReader : public IReader
+{
+public:
+    explicit MmapReader(AccessPattern pattern = AccessPattern::Sequential);
+    ~MmapReader() override;
+
+    MmapReader(const MmapReader&) = delete;
+    MmapReader& operator=(const MmapReader&) = delete;
+
+    void open(const std::string& filename) override;
+    void close() override;
+
+    uint64_t getContentLength() override;
+    uint64_t currentPosition() override;
+    bool eof() override;
+    std::string uri() override;
+
+    void seekAbsolute(uint64_t position) override;
+    void seekRelative(uint64_t offset) override;
+    uint64_t read(uint8_t* pData, uint64_t size) override;
+    std::vector<uint8_t> readAllData() override;
+    void clearErrors() override;
+    ByteSpan peek(uint64_t size) override;
+
+    // The complete contents of the file
+    ByteSpan data() const noexcept;
+
+    // At most size bytes starting at offset, shorter at the end of the file
+    ByteSpan span(uint64_t offset, uint64_t size) const noexcept;
+
+    // Change the access pattern hint of a range of the file, size 0 means until the end
+    void advise(AccessPattern pattern, uint64_t offset = 0, uint64_t size = 0);
+
+private:
+    std::string         m_fileName;
+    AccessPattern       m_pattern;
+    uint8_t*            m_data;
+    uint64_t            m_size;
+    uint64_t            m_position;
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef UTILS_POSIX_FILE_READER_H
+#define UTILS_POSIX_FILE_READER_H
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "utils/readerinterface.h"
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+
+namespace utils
+{
+
+enum class IoMode
+{
+    Cached,
+    // Bypass the page cache (O_DIRECT), falls back to cached io on file systems that do not support it
+    Direct
+};
+
+// File reader on top of a file descriptor using positional reads (POSIX only)
+// The content length is obtained once when the file is opened.
+// readAt does not use the current position and can be called concurrently from multiple threads,
+// e.g. to let worker threads read disjoint regions of the same file.
+class PosixFileReader : public IReader
+{
+public:
+    // Offsets and sizes of the reads done in direct io mode are aligned to this size
+    static constexpr uint64_t DirectIoAlignment = 4096;
+
+    explicit PosixFileReader(IoMode mode = IoMode::Cached);
+    ~PosixFileReader() override;
+
+    PosixFileReader(const PosixFileReader&) = delete;
+    PosixFileReader& operator=(const PosixFileReader&) = delete;
+
+    void open(const std::string& filename) override;
+    void close() override;
+
+    uint64_t getContentLength() override;
+    uint64_t currentPosition() override;
+    bool eof() override;
+    std::string uri() override;
+
+    void seekAbsolute(uint64_t position) override;
+    void seekRelative(uint64_t offset) override;
+    uint64_t read(uint8_t* pData, uint64_t size) override;
+    std::vector<uint8_t> readAllData() override;
+    void clearErrors() override;
+    ByteSpan peek(uint64_t size) override;
+
+    // Reads at most size bytes starting at offset, fewer bytes are only returned at the end of the file
+    // In direct io mode offset, size and pData must be aligned to DirectIoAlignment
+    // Throws std::runtime_error when the read fails
+    uint64_t readAt(uint64_t offset, uint8_t* pData, uint64_t size) const;
+
+    // The io mode that is in use, direct io can be unavailable for the file system of the file
+    IoMode mode() const noexcept;
+
+private:
+    struct FreeDeleter
+    {
+        void operator()(uint8_t* ptr) const noexcept { free(ptr); }
+    };
+
+    IoMode                                  m_mode;
+    IoMode                                  m_requestedMode;
+    int                                     m_fd;
+    std::string                             m_fileName;
+    uint64_t                                m_size;
+    uint64_t                                m_position;
+
+    // read ahead window used by peek, aligned for direct io
+    std::unique_ptr<uint8_t[], FreeDeleter> m_window;
+    uint64_t                                m_windowCapacity;
+    uint64_t                                m_windowPosition;
+    uint64_t                                m_windowSize;
+};
+
+}
+
+#endif
+
+#endif
@@ -31,10 +31,22 @@ class ReaderFactory
 public:
     static void registerBuilder(std::unique_ptr<IReaderBuilder> builder);
     static utils::IReader* create(const std::string& uri);
-    static utils::IReader* createBuffered(const std::string& filepath, uint32_t bufferSize);
+    static utils::IReader* createBuffered(const std::string& filepath, uint32_t bufferSize, uint32_t readAheadBuffers = 0);
+
+    // Regular files of at least this size are memory mapped instead of read through a stream
+    // when no builder supports the uri (POSIX only). Memory mapping is disabled by default (UINT64_MAX):
+    // the process receives SIGBUS when a mapped file is truncated while it is being read,
+    // only enable it for files that are not modified by other processes.
+    static void setMmapThreshold(uint64_t size);
+
+    // Read the files that are not memory mapped with a PosixFileReader instead of a FileReader (POSIX only)
+    // Disabled by default
+    static void setPositionalReads(bool enabled);
 
 private:
     static std::vector<std::unique_ptr<IReaderBuilder>>  m_builders;
+    static uint64_t                                      m_mmapThreshold;
+    static bool                                          m_positionalReads;
 };
 
 }
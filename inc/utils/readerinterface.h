@@ -24,6 +24,17 @@
 namespace utils
 {
 
+// Non owning view of a range of bytes that belong to a reader
+struct ByteSpan
+{
+    const uint8_t*  data = nullptr;
+    uint64_t        size = 0;
+
+    bool empty() const noexcept { return size == 0; }
+    const uint8_t* begin() const noexcept { return data; }
+    const uint8_t* end() const noexcept { return data + size; }
+};
+
 class IReader
 {
 public:
@@ -43,6 +54,59 @@ public:
     virtual uint64_t read(uint8_t* pData, uint64_t size) = 0;
 
     virtual std::vector<uint8_t> readAllData() = 0;
+
+    // Zero copy access to the next size bytes without modifying the current position, e.g.:
+    //   auto header = reader.peek(16);
+    //   parseHeader(header);
+    //   reader.consume(header.size);
+    // The span is only shorter than size at the end of the data. It points into the buffer or
+    // mapping of the reader and remains valid until the next non const call on the reader.
+    // Readers that can not give access to their data without copying can use PeekBuffer.
+    virtual ByteSpan peek(uint64_t size) = 0;
+
+    // Advances the current position past data that was obtained with peek
+    virtual void consume(uint64_t size)
+    {
+        seekRelative(size);
+    }
+};
+
+// Implements peek by reading into a buffer and seeking back, e.g.:
+//   ByteSpan peek(uint64_t size) override { return m_peekBuffer.peek(*this, size); }
+class PeekBuffer
+{
+public:
+    ByteSpan peek(IReader& reader, uint64_t size)
+    {
+        auto position = reader.currentPosition();
+
+        m_buffer.resize(size);
+        uint64_t bytes = 0;
+        try
+        {
+            while (bytes < size)
+            {
+                auto read = reader.read(m_buffer.data() + bytes, size - bytes);
+                if (read == 0)
+                {
+                    break;
+                }
+
+                bytes += read;
+            }
+        }
+        catch (...)
+        {
+            reader.seekAbsolute(position);
+            throw;
+        }
+
+        reader.seekAbsolute(position);
+        return ByteSpan{m_buffer.data(), bytes};
+    }
+
+private:
+    std::vector<uint8_t> m_buffer;
 };
 
 class IReaderBuilder
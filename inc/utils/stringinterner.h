@@ -0,0 +1,148 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace utils
+{
+
+class StringInterner;
+
+// Handle to a string that is stored in a StringInterner
+// Handles of the same interner are equal when the strings are equal, so comparing them is a
+// pointer comparison and hashing them returns the stored hash.
+// The handle remains valid for the lifetime of the interner.
+class InternedString
+{
+public:
+    InternedString() noexcept = default;
+
+    std::string_view view() const noexcept
+    {
+        return m_entry ? std::string_view(reinterpret_cast<const char*>(m_entry + 1), m_entry->size) : std::string_view();
+    }
+
+    operator std::string_view() const noexcept
+    {
+        return view();
+    }
+
+    // The strings are stored zero terminated
+    const char* c_str() const noexcept
+    {
+        return m_entry ? reinterpret_cast<const char*>(m_entry + 1) : "";
+    }
+
+    size_t size() const noexcept
+    {
+        return m_entry ? m_entry->size : 0;
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    // A default constructed handle or the result of a failed StringInterner::find is not valid
+    bool valid() const noexcept
+    {
+        return m_entry != nullptr;
+    }
+
+    friend bool operator==(InternedString lhs, InternedString rhs) noexcept
+    {
+        return lhs.m_entry == rhs.m_entry;
+    }
+
+    friend bool operator!=(InternedString lhs, InternedString rhs) noexcept
+    {
+        return lhs.m_entry != rhs.m_entry;
+    }
+
+private:
+    friend class StringInterner;
+    friend struct std::hash<InternedString>;
+
+    // Stored in the arena, directly followed by the characters
+    struct Entry
+    {
+        uint64_t hash;
+        size_t size;
+    };
+
+    explicit InternedString(const Entry* entry) noexcept
+    : m_entry(entry)
+    {
+    }
+
+    const Entry* m_entry = nullptr;
+};
+
+// Thread safe string pool that stores every distinct string once, e.g. for the
+// highly repetitive fields of a parsed file:
+//   InternedString country = interner.intern(fields[3]);
+// The strings are stored in per shard arenas and are only released when the interner
+// is destroyed. Lookups of strings that are already interned take a shared lock on one
+// of the shards, so concurrent lookups do not block each other.
+class StringInterner
+{
+public:
+    // The number of shards is rounded up to the next power of two
+    explicit StringInterner(size_t shardCount = 64);
+    ~StringInterner() noexcept;
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // Returns the handle of str, the string is added when it is not interned yet
+    InternedString intern(std::string_view str);
+
+    // Returns the handle of str, an invalid handle when it is not interned
+    InternedString find(std::string_view str) const;
+
+    // Number of distinct strings
+    size_t size() const;
+
+private:
+    struct Shard;
+
+    Shard& shard(uint64_t hash) const noexcept;
+
+    size_t m_shardMask;
+    std::unique_ptr<Shard[]> m_shards;
+};
+
+}
+
+namespace std
+{
+
+template <>
+struct hash<utils::InternedString>
+{
+    size_t operator()(utils::InternedString str) const noexcept
+    {
+        return static_cast<size_t>(str.m_entry ? str.m_entry->hash : 0);
+    }
+};
+
+}
@@ -17,17 +17,27 @@
 #pragma once
 
 #include "utils/enumflags.h"
+#include "utils/format.h"
 #include "utils/traits.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cctype>
+#include <charconv>
+#include <cstdint>
 #include <cstring>
 #include <cwchar>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <iostream>
@@ -37,43 +47,189 @@ namespace utils
 namespace str
 {
 
+// Case conversion only changes the ASCII letters, other bytes are left untouched
+// so it is locale independent and safe to use on UTF-8 strings
 void lowercase_in_place(std::string& aString);
 void uppercase_in_place(std::string& aString);
 
 [[nodiscard]] std::string lowercase(std::string_view aString);
-[[nodiscard]] std::string uppercase(const std::string& aString);
+[[nodiscard]] std::string uppercase(std::string_view aString);
 
-std::string_view trimmed_view(std::string_view str);
-void             trim_in_place(std::string& str);
+// Writes the converted characters of aString to output, which must hold aString.size() characters
+// output can point to the data of aString for an in place conversion
+void lowercase_into(std::string_view aString, char* output) noexcept;
+void uppercase_into(std::string_view aString, char* output) noexcept;
 
-[[nodiscard]] std::string trim(std::string_view str);
+// ASCII case insensitive comparisons, no lowercase copies are made
+bool iequals(std::string_view lhs, std::string_view rhs) noexcept;
+bool istarts_with(std::string_view aString, std::string_view search) noexcept;
+size_t ifind(std::string_view str, std::string_view search, size_t pos = 0) noexcept;
 
-inline void replace(std::string& aString, std::string_view toSearch, std::string_view toReplace)
+// Set of characters stored as a 256 bit bitmap that can be built at compile time, e.g.:
+//   constexpr char_set separators(" ,;");
+class char_set
 {
-    size_t startPos = 0;
-    size_t foundPos;
+public:
+    // Sets with up to MaxVectorizedSize distinct characters use the vectorized search functions
+    static constexpr size_t MaxVectorizedSize = 16;
 
-    while (std::string::npos != (foundPos = aString.find(toSearch, startPos)))
+    constexpr explicit char_set(std::string_view chars) noexcept
     {
-        aString.replace(foundPos, toSearch.length(), toReplace);
-        startPos = foundPos + toReplace.size();
+        for (char c : chars)
+        {
+            if (!contains(c))
+            {
+                auto byte = static_cast<unsigned char>(c);
+                m_bits[byte / 64] |= uint64_t(1) << (byte % 64);
+
+                if (m_size < MaxVectorizedSize)
+                {
+                    m_chars[m_size] = c;
+                }
+
+                ++m_size;
+            }
+        }
+    }
+
+    constexpr bool contains(char c) const noexcept
+    {
+        auto byte = static_cast<unsigned char>(c);
+        return (m_bits[byte / 64] >> (byte % 64)) & 1;
+    }
+
+    // Number of distinct characters in the set
+    constexpr size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    // The distinct characters, empty if there are more than MaxVectorizedSize
+    constexpr std::string_view chars() const noexcept
+    {
+        return m_size <= MaxVectorizedSize ? std::string_view(m_chars.data(), m_size) : std::string_view();
+    }
+
+private:
+    std::array<uint64_t, 4> m_bits  = {};
+    std::array<char, MaxVectorizedSize> m_chars = {};
+    size_t m_size = 0;
+};
+
+inline constexpr char_set whitespace(" \t\r\n");
+
+namespace detail
+{
+std::string_view trimmed_view(std::string_view str, const char_set& chars) noexcept;
+size_t find(std::string_view str, std::string_view search, size_t pos) noexcept;
+}
+
+// Trimming skips the first bytes one by one, long runs of padding are skipped using
+// vectorized compares when the set has no more than char_set::MaxVectorizedSize characters
+// Usable in constant expressions, e.g.: static_assert(trimmed_view(" key ") == "key");
+constexpr std::string_view trimmed_view(std::string_view str, const char_set& chars = whitespace) noexcept
+{
+    if (is_constant_evaluated())
+    {
+        size_t begin = 0;
+        size_t end   = str.size();
+        while (begin < end && chars.contains(str[begin]))
+        {
+            ++begin;
+        }
+
+        while (end > begin && chars.contains(str[end - 1]))
+        {
+            --end;
+        }
+
+        return str.substr(begin, end - begin);
     }
+
+    return detail::trimmed_view(str, chars);
 }
 
-inline bool startsWith(std::string_view aString, std::string_view search)
+void             trim_in_place(std::string& str, const char_set& chars = whitespace);
+
+[[nodiscard]] std::string trim(std::string_view str, const char_set& chars = whitespace);
+
+// Trims all the views in [tokens, tokens + count) in place, e.g. the output of splitted_view
+void trim_all(std::string_view* tokens, size_t count, const char_set& chars = whitespace) noexcept;
+
+template <typename Container>
+void trim_all(Container& tokens, const char_set& chars = whitespace) noexcept
 {
-    return aString.compare(0, search.size(), search) == 0;
+    trim_all(tokens.data(), tokens.size(), chars);
 }
 
-inline bool endsWith(const std::string& aString, std::string_view search)
+// Position of the first occurrence of search in str at or after pos, std::string_view::npos if not found
+// Uses a vectorized substring search, all substring searches in this module go through here
+constexpr size_t find(std::string_view str, std::string_view search, size_t pos = 0) noexcept
 {
-    if (search.size() > aString.size())
+    if (is_constant_evaluated())
     {
-        return false;
+        return str.find(search, pos);
     }
 
-    //return aString.rfind(search) == (aString.size() - search.size()); // Fails on llvm < 5.0.1
-    return aString.rfind(search.data(), std::string::npos, search.size()) == (aString.size() - search.size());
+    return detail::find(str, search, pos);
+}
+
+// Replaces all the non overlapping occurrences of toSearch, scanning from left to right
+// Single pass: when the replacement is not longer the string is updated in place,
+// otherwise the result is built once with the exact output length
+// An empty toSearch leaves the string untouched
+void replace(std::string& aString, std::string_view toSearch, std::string_view toReplace);
+
+// Replaces many patterns in a single pass using an Aho-Corasick automaton
+// At every position the longest matching pattern wins, replacements are not rescanned
+// Construct it once and reuse it to avoid rebuilding the automaton, e.g.:
+//   replacer placeholders({{"{{name}}", name}, {"{{date}}", date}});
+//   auto text = placeholders.replace(templateText);
+class replacer
+{
+public:
+    using replacement = std::pair<std::string_view, std::string_view>;
+
+    replacer(std::initializer_list<replacement> replacements);
+    explicit replacer(const std::vector<replacement>& replacements);
+
+    [[nodiscard]] std::string replace(std::string_view str) const;
+
+    // Appends the result to output
+    void replace(std::string_view str, std::string& output) const;
+
+private:
+    void build(const replacement* replacements, size_t count);
+    size_t findMatch(std::string_view str, size_t pos, int32_t& pattern) const noexcept;
+
+    static constexpr int32_t NoPattern = -1;
+
+    struct State
+    {
+        std::array<int32_t, 256> next;
+        // length of the path from the root
+        int32_t depth = 0;
+        // longest pattern that is a suffix of this state, NoPattern if none
+        int32_t pattern = NoPattern;
+    };
+
+    std::vector<State>          m_states;
+    std::vector<std::string>    m_patterns;
+    std::vector<std::string>    m_replacements;
+    // the first byte of every pattern when they all start with the same byte, -1 otherwise
+    int32_t                     m_firstByte = -1;
+};
+
+[[nodiscard]] std::string replace_all(std::string_view str, std::initializer_list<replacer::replacement> replacements);
+
+constexpr bool startsWith(std::string_view aString, std::string_view search) noexcept
+{
+    return aString.size() >= search.size() && aString.compare(0, search.size(), search) == 0;
+}
+
+constexpr bool endsWith(std::string_view aString, std::string_view search) noexcept
+{
+    return aString.size() >= search.size() && aString.compare(aString.size() - search.size(), search.size(), search) == 0;
 }
 
 inline void dos2unix(std::string& aString)
@@ -81,126 +237,826 @@ inline void dos2unix(std::string& aString)
     replace(aString, "\r\n", "\n");
 }
 
-std::string urlEncode(const std::string& aString);
+enum class url_encoding
+{
+    rfc3986, // only A-Z a-z 0-9 - . _ ~ are left as is, a space becomes %20
+    form     // application/x-www-form-urlencoded: A-Z a-z 0-9 * - . _ are left as is, a space becomes '+'
+};
 
-// Join items in the container with the provided join string
-// e.g.: join(std::vector<std::string>({"one", "two"}), ", ") == "one, two"
-template <typename Container>
-std::string join(const Container& items, std::string_view joinString)
+// Everything that is not left as is gets encoded as a two digit uppercase escape: e.g. '@' -> "%40"
+[[nodiscard]] std::string urlEncode(std::string_view str, url_encoding encoding = url_encoding::form);
+
+// Encode into a caller provided buffer that holds at least urlEncodedSize(str) characters
+// Returns the number of characters that were written
+size_t urlEncodedSize(std::string_view str, url_encoding encoding = url_encoding::form) noexcept;
+size_t urlEncode(std::string_view str, char* output, url_encoding encoding = url_encoding::form) noexcept;
+
+// Decodes the %XX escapes (and '+' in form encoding), malformed escapes are copied as is
+[[nodiscard]] std::string urlDecode(std::string_view str, url_encoding encoding = url_encoding::form);
+
+// Decode into a caller provided buffer that holds at least str.size() characters
+// Returns the number of characters that were written
+size_t urlDecode(std::string_view str, char* output, url_encoding encoding = url_encoding::form) noexcept;
+
+enum class split_opt
 {
-    using ValueType = typename Container::value_type;
-    static_assert(can_cast_to_string_view_v<ValueType> || is_streamable_v<ValueType>,
-        "Items to join should be streamable or convertible to string_view");
+    no_empty = 1 << 0,
+    trim     = 1 << 1
+};
 
-    std::string result;
+// Character delimiters: a trailing delimiter only ends a token when the token before it was empty,
+// so "a," gives {"a"}, "a,," gives {"a", "", ""} and "," gives {"", ""}.
+// When the options leave no token the input itself is the only token (with the options applied),
+// e.g. ",," with no_empty gives {",,"} and "" with no_empty gives no tokens at all.
+// String delimiters: every delimiter ends a token, "a::" gives {"a", ""} and "::::" with no_empty
+// gives no tokens at all.
+std::vector<std::string> split(std::string_view str, char delimiter, flags<split_opt> opt = flags<split_opt>());
+std::vector<std::string> split(std::string_view str, const std::string& delimiter, flags<split_opt> opt = flags<split_opt>());
+
+std::vector<std::string_view> splitted_view(std::string_view str, char delimiter, flags<split_opt> opt = flags<split_opt>());
+std::vector<std::string_view> splitted_view(std::string_view str, std::string_view delimiter, flags<split_opt> opt = flags<split_opt>());
 
-    if (items.empty())
+inline constexpr flags<split_opt> operator|(split_opt lhs, split_opt rhs) noexcept
+{
+    return flags<split_opt>() | lhs | rhs;
+}
+
+// Delimiter types for split_range
+struct char_delimiter
+{
+    char_delimiter(char c) noexcept
+    : value(c)
+    {
+    }
+
+    size_t find(std::string_view str, size_t pos) const noexcept
     {
-        return result;
+        return str.find(value, pos);
     }
 
-    if constexpr (can_cast_to_string_view_v<ValueType>)
+    size_t size() const noexcept
     {
-        // Join implementation for objects that implement: std::basic_string::operator basic_string_view
-        // This implementation is roughly 10 times faster the ostream version for strings
+        return 1;
+    }
 
-        size_t inputSize = 0;
-        for (auto& item : items)
+    char value;
+};
+
+struct string_delimiter
+{
+    template <typename T, typename = std::enable_if_t<std::is_convertible_v<const T&, std::string_view>>>
+    string_delimiter(const T& delimiter) noexcept
+    : value(delimiter)
+    {
+    }
+
+    size_t find(std::string_view str, size_t pos) const noexcept
+    {
+        // an empty delimiter never matches
+        return value.empty() ? std::string_view::npos : str::find(str, value, pos);
+    }
+
+    size_t size() const noexcept
+    {
+        return value.size();
+    }
+
+    std::string_view value;
+};
+
+// String delimiter that keeps a copy, used when split_range is constructed from a temporary std::string
+struct owned_string_delimiter
+{
+    owned_string_delimiter(std::string delimiter) noexcept
+    : value(std::move(delimiter))
+    {
+    }
+
+    size_t find(std::string_view str, size_t pos) const noexcept
+    {
+        return value.empty() ? std::string_view::npos : str::find(str, value, pos);
+    }
+
+    size_t size() const noexcept
+    {
+        return value.size();
+    }
+
+    std::string value;
+};
+
+// Every character in the set is a delimiter, e.g.: split_range(str, any_of(",;"))
+struct any_of
+{
+    explicit any_of(std::string_view chars) noexcept
+    : value(chars)
+    {
+    }
+
+    size_t find(std::string_view str, size_t pos) const noexcept
+    {
+        return str.find_first_of(value, pos);
+    }
+
+    size_t size() const noexcept
+    {
+        return 1;
+    }
+
+    std::string_view value;
+};
+
+// Lazily splits a string: a token is only located when the iterator is advanced
+// and nothing is allocated, the tokens are views in the original string.
+// Yields the same tokens as splitted_view, char_delimiter and any_of follow the character delimiter rules, e.g.:
+//   for (auto field : split_range(line, ',')) { ... }
+//   auto third = *std::next(split_range(line, ',').begin(), 2);
+template <typename Delimiter>
+class split_range
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const std::string_view*;
+        using reference         = const std::string_view&;
+
+        iterator() = default;
+
+        reference operator*() const noexcept
         {
-            inputSize += static_cast<std::string_view>(item).size();
+            return m_token;
         }
 
-        size_t resultSize = inputSize + ((items.size() - 1) * joinString.size());
-        result.reserve(resultSize);
+        pointer operator->() const noexcept
+        {
+            return &m_token;
+        }
 
-        for (auto& item : items)
+        iterator& operator++() noexcept
         {
-            result += static_cast<std::string_view>(item);
+            advance();
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            auto copy = *this;
+            advance();
+            return copy;
+        }
+
+        bool operator==(const iterator& other) const noexcept
+        {
+            return m_end == other.m_end && (m_end || (m_next == other.m_next && m_token.data() == other.m_token.data()));
+        }
+
+        bool operator!=(const iterator& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class split_range;
+
+        static constexpr bool CharacterRules = std::is_same_v<Delimiter, char_delimiter> || std::is_same_v<Delimiter, any_of>;
+
+        explicit iterator(const split_range* range) noexcept
+        : m_range(range)
+        , m_next(0)
+        , m_end(false)
+        {
+            advance();
+        }
+
+        bool accept(std::string_view token) noexcept
+        {
+            if (m_range->m_opt.is_set(split_opt::trim))
+            {
+                token = trimmed_view(token);
+            }
 
-            if (result.size() < resultSize)
+            if (!m_range->m_opt.is_set(split_opt::no_empty) || !token.empty())
             {
-                result += joinString;
+                m_token   = token;
+                m_emitted = true;
+                return true;
             }
+
+            return false;
         }
-    }
-    else if constexpr (is_streamable_v<ValueType>)
-    {
-        // Join implementation for objects that have a streaming operator implemented
-        std::ostringstream ss;
-        for (auto iter = items.cbegin(); iter != items.cend(); ++iter)
+
+        void advance() noexcept
         {
-            ss << *iter;
-            if (iter + 1 != items.cend())
+            const auto& str = m_range->m_str;
+            for (;;)
             {
-                ss << joinString;
+                if (m_next == std::string_view::npos)
+                {
+                    // character delimiters yield the input itself when no token is left
+                    if constexpr (CharacterRules)
+                    {
+                        if (!m_emitted && accept(str))
+                        {
+                            return;
+                        }
+                    }
+
+                    m_end = true;
+                    return;
+                }
+
+                auto delimiterPos = m_range->m_delimiter.find(str, m_next);
+                if (delimiterPos == std::string_view::npos)
+                {
+                    auto token = str.substr(m_next);
+                    m_next     = std::string_view::npos;
+
+                    // a trailing character delimiter only ends a token when the token before it was empty
+                    if (CharacterRules && token.empty() && !m_previousEmpty)
+                    {
+                        continue;
+                    }
+
+                    if (accept(token))
+                    {
+                        return;
+                    }
+                }
+                else
+                {
+                    auto token      = str.substr(m_next, delimiterPos - m_next);
+                    m_next          = delimiterPos + m_range->m_delimiter.size();
+                    m_previousEmpty = token.empty();
+
+                    if (accept(token))
+                    {
+                        return;
+                    }
+                }
             }
         }
 
-        result = ss.str();
+        const split_range*  m_range = nullptr;
+        std::string_view    m_token;
+        size_t              m_next          = std::string_view::npos;
+        bool                m_end           = true;
+        bool                m_previousEmpty = false;
+        bool                m_emitted       = false;
+    };
+
+    split_range(std::string_view str, Delimiter delimiter, flags<split_opt> opt = flags<split_opt>()) noexcept
+    : m_str(str)
+    , m_delimiter(std::move(delimiter))
+    , m_opt(opt)
+    {
     }
 
-    return result;
+    iterator begin() const noexcept
+    {
+        return iterator(this);
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator();
+    }
+
+private:
+    std::string_view    m_str;
+    Delimiter           m_delimiter;
+    flags<split_opt>    m_opt;
+};
+
+split_range(std::string_view, char)->split_range<char_delimiter>;
+split_range(std::string_view, char, flags<split_opt>)->split_range<char_delimiter>;
+split_range(std::string_view, std::string_view)->split_range<string_delimiter>;
+split_range(std::string_view, std::string_view, flags<split_opt>)->split_range<string_delimiter>;
+split_range(std::string_view, const char*)->split_range<string_delimiter>;
+split_range(std::string_view, const char*, flags<split_opt>)->split_range<string_delimiter>;
+split_range(std::string_view, const std::string&)->split_range<string_delimiter>;
+split_range(std::string_view, const std::string&, flags<split_opt>)->split_range<string_delimiter>;
+split_range(std::string_view, std::string&&)->split_range<owned_string_delimiter>;
+split_range(std::string_view, std::string&&, flags<split_opt>)->split_range<owned_string_delimiter>;
+split_range(std::string_view, any_of)->split_range<any_of>;
+split_range(std::string_view, any_of, flags<split_opt>)->split_range<any_of>;
+
+// Split into caller provided storage, the tokens are appended to the output container
+// e.g.: fields.clear(); split_into(line, ',', fields);
+// Reusing the container avoids reallocating it for every split
+// Returns the number of tokens that were appended
+template <typename Delimiter, typename Container>
+size_t split_into(std::string_view str, const Delimiter& delimiter, Container& output, flags<split_opt> opt = flags<split_opt>())
+{
+    size_t count = 0;
+    for (auto token : split_range(str, delimiter, opt))
+    {
+        output.emplace_back(token);
+        ++count;
+    }
+
+    return count;
 }
 
-// Join implementation for objects where the tostring implementation is provided as a callable
-template <typename Container, typename ToStringCb>
-std::string join(const Container& items, const std::string& joinString, ToStringCb&& cb)
+// Split into a fixed number of fields, splitting stops when all the fields are filled in
+// Returns the number of fields that were written
+template <typename Delimiter>
+size_t split_into(std::string_view str, const Delimiter& delimiter, std::string_view* fields, size_t capacity, flags<split_opt> opt = flags<split_opt>())
 {
-    std::ostringstream ss;
-    for (auto iter = begin(items); iter != end(items); ++iter)
+    size_t count = 0;
+    if (capacity == 0)
+    {
+        return count;
+    }
+
+    for (auto token : split_range(str, delimiter, opt))
     {
-        ss << cb(*iter);
-        if (iter + 1 != end(items))
+        fields[count++] = token;
+        if (count == capacity)
         {
-            ss << joinString;
+            break;
         }
     }
 
-    return ss.str();
+    return count;
 }
 
-enum class split_opt
+template <typename Delimiter, size_t N>
+size_t split_into(std::string_view str, const Delimiter& delimiter, std::array<std::string_view, N>& fields, flags<split_opt> opt = flags<split_opt>())
 {
-    no_empty = 1 << 0,
-    trim     = 1 << 1
+    return split_into(str, delimiter, fields.data(), N, opt);
+}
+
+// Split into a fixed number of fields that can be evaluated at compile time, e.g.:
+//   constexpr auto fields = split_array<3>("GET /index.html HTTP/1.1", ' ');
+// Like split_into, splitting stops when all the fields are filled in, missing fields are empty
+template <size_t N>
+constexpr std::array<std::string_view, N> split_array(std::string_view str, std::string_view delimiter, flags<split_opt> opt = flags<split_opt>()) noexcept
+{
+    std::array<std::string_view, N> fields = {};
+
+    size_t count = 0;
+    size_t pos   = 0;
+    while (count < N)
+    {
+        // an empty delimiter never matches
+        auto end   = delimiter.empty() ? std::string_view::npos : find(str, delimiter, pos);
+        auto token = str.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+        if (opt.is_set(split_opt::trim))
+        {
+            token = trimmed_view(token);
+        }
+
+        if (!opt.is_set(split_opt::no_empty) || !token.empty())
+        {
+            fields[count++] = token;
+        }
+
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+
+        pos = end + delimiter.size();
+    }
+
+    return fields;
+}
+
+template <size_t N>
+constexpr std::array<std::string_view, N> split_array(std::string_view str, char delimiter, flags<split_opt> opt = flags<split_opt>()) noexcept
+{
+    auto fields = split_array<N>(str, std::string_view(&delimiter, 1), opt);
+    if constexpr (N > 0)
+    {
+        // like splitted_view, the input itself is the only field when no_empty leaves no token
+        if (opt.is_set(split_opt::no_empty) && fields[0].empty())
+        {
+            fields[0] = opt.is_set(split_opt::trim) ? trimmed_view(str) : str;
+        }
+    }
+
+    return fields;
+}
+
+// Split with owned token copies that are allocated from the provided memory resource
+// e.g.: std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+//       auto tokens = split(line, ',', arena);
+std::pmr::vector<std::pmr::string> split(std::string_view str, char delimiter, std::pmr::memory_resource& arena, flags<split_opt> opt = flags<split_opt>());
+std::pmr::vector<std::pmr::string> split(std::string_view str, std::string_view delimiter, std::pmr::memory_resource& arena, flags<split_opt> opt = flags<split_opt>());
+
+// Result of a numeric conversion: the value or the reason it failed
+// std::errc::invalid_argument: the string is not a number
+// std::errc::result_out_of_range: the number does not fit in T
+template <typename T>
+class parse_result
+{
+public:
+    constexpr parse_result(T value) noexcept
+    : m_value(value)
+    , m_error()
+    {
+    }
+
+    constexpr parse_result(std::errc error) noexcept
+    : m_value()
+    , m_error(error)
+    {
+    }
+
+    constexpr bool has_value() const noexcept
+    {
+        return m_error == std::errc();
+    }
+
+    constexpr explicit operator bool() const noexcept
+    {
+        return has_value();
+    }
+
+    // Throws std::invalid_argument or std::out_of_range when there is no value
+    constexpr T value() const
+    {
+        if (m_error == std::errc::result_out_of_range)
+        {
+            throw std::out_of_range("Numeric value out of range");
+        }
+
+        if (m_error != std::errc())
+        {
+            throw std::invalid_argument("Invalid numeric value");
+        }
+
+        return m_value;
+    }
+
+    constexpr T value_or(T defaultValue) const noexcept
+    {
+        return has_value() ? m_value : defaultValue;
+    }
+
+    constexpr T operator*() const noexcept
+    {
+        assert(has_value());
+        return m_value;
+    }
+
+    constexpr std::errc error() const noexcept
+    {
+        return m_error;
+    }
+
+private:
+    T           m_value;
+    std::errc   m_error;
 };
 
-std::vector<std::string> split(std::string_view str, char delimiter, flags<split_opt> opt = flags<split_opt>());
-std::vector<std::string> split(std::string_view str, const std::string& delimiter, flags<split_opt> opt = flags<split_opt>());
+// Locale independent conversion of the complete string to a number, does not allocate
+// e.g.: parse<int>("42").value_or(0), parse<double>("1.5e3")
+// Leading whitespace, a leading '+' or trailing characters make the conversion fail
+template <typename T>
+parse_result<T> parse(std::string_view str) noexcept
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "parse requires a numeric type");
 
-std::vector<std::string_view> splitted_view(std::string_view str, char delimiter, flags<split_opt> opt = flags<split_opt>());
-std::vector<std::string_view> splitted_view(std::string_view str, std::string_view delimiter, flags<split_opt> opt = flags<split_opt>());
+    T value;
+    const auto* end = str.data() + str.size();
 
-inline constexpr flags<split_opt> operator|(split_opt lhs, split_opt rhs) noexcept
+    std::from_chars_result result;
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        result = std::from_chars(str.data(), end, value, std::chars_format::general);
+    }
+    else
+    {
+        result = std::from_chars(str.data(), end, value);
+    }
+
+    if (result.ec != std::errc())
+    {
+        return result.ec;
+    }
+
+    if (result.ptr != end)
+    {
+        return std::errc::invalid_argument;
+    }
+
+    return value;
+}
+
+// Bulk conversion of tokens (e.g. the result of splitted_view) into output,
+// output must have room for all the tokens
+// Returns the number of converted values, conversion stops at the first invalid token
+template <typename T, typename Tokens>
+size_t parse_all(const Tokens& tokens, T* output) noexcept
 {
-    return flags<split_opt>() | lhs | rhs;
+    size_t count = 0;
+    for (std::string_view token : tokens)
+    {
+        auto result = parse<T>(token);
+        if (!result)
+        {
+            break;
+        }
+
+        output[count++] = *result;
+    }
+
+    return count;
+}
+
+// Bulk conversion that appends the values to output, reusing its capacity
+template <typename T, typename Tokens>
+size_t parse_all(const Tokens& tokens, std::vector<T>& output)
+{
+    size_t count = 0;
+    for (std::string_view token : tokens)
+    {
+        auto result = parse<T>(token);
+        if (!result)
+        {
+            break;
+        }
+
+        output.push_back(*result);
+        ++count;
+    }
+
+    return count;
+}
+
+namespace detail
+{
+
+// Character types are streamed as characters, not converted as numbers
+template <typename T>
+inline constexpr bool is_character_v = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char> ||
+                                       std::is_same_v<T, wchar_t> || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+template <typename T>
+inline constexpr bool is_numeric_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !is_character_v<T>;
+
+}
+
+// Throws std::invalid_argument or std::out_of_range if the string is not a valid value of type T
+// Numbers accept surrounding whitespace and a leading '+' (as the stream based conversion did), use parse for strict conversions
+// bool, character types and other types are extracted with a stream, e.g. toNumeric<char>("a") == 'a'
+template <typename T>
+inline T toNumeric(std::string_view aString)
+{
+    if constexpr (detail::is_numeric_v<T>)
+    {
+        auto str = trimmed_view(aString);
+        if (str.size() > 1 && str[0] == '+' && str[1] != '-')
+        {
+            str.remove_prefix(1);
+        }
+
+        return parse<T>(str).value();
+    }
+    else
+    {
+        T value;
+        std::istringstream ss{std::string(aString)};
+        if (!(ss >> value))
+        {
+            throw std::invalid_argument("Invalid value");
+        }
+
+        return value;
+    }
 }
 
+// Writes the shortest representation that converts back to the same value
+// into buffer, returns the number of characters that were written
+// buffer must hold at least MaxNumericLength characters
+constexpr size_t MaxNumericLength = 64;
+
 template <typename T>
-inline T toNumeric(const std::string& aString)
+size_t toChars(T numeric, char* buffer) noexcept
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "toChars requires a numeric type");
+
+    auto result = std::to_chars(buffer, buffer + MaxNumericLength, numeric);
+    assert(result.ec == std::errc());
+    return static_cast<size_t>(result.ptr - buffer);
+}
+
+namespace detail
 {
-    T numeric;
 
-    std::stringstream ss(aString);
-    ss >> numeric;
+// Same output as the default stream formatting: floating point values with 6 significant digits
+template <typename T>
+size_t toStreamChars(T numeric, char* buffer) noexcept
+{
+    std::to_chars_result result;
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        result = std::to_chars(buffer, buffer + MaxNumericLength, numeric, std::chars_format::general, 6);
+    }
+    else
+    {
+        result = std::to_chars(buffer, buffer + MaxNumericLength, numeric);
+    }
 
-    return numeric;
+    assert(result.ec == std::errc());
+    return static_cast<size_t>(result.ptr - buffer);
+}
+
+}
+
+// Formats like streaming the value, e.g.: toString(1.0 / 3) == "0.333333"
+// use toChars for the shortest representation that converts back to the same value
+template <typename T>
+inline std::string toString(T value)
+{
+    if constexpr (detail::is_numeric_v<T>)
+    {
+        char buffer[MaxNumericLength];
+        return std::string(buffer, detail::toStreamChars(value, buffer));
+    }
+    else
+    {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    }
 }
 
 template <typename T>
-inline std::string toString(T numeric)
+inline std::wstring toWstring(T value)
 {
-    std::stringstream ss;
-    ss << numeric;
-    return ss.str();
+    if constexpr (detail::is_numeric_v<T>)
+    {
+        // the numeric representation only contains ASCII characters
+        char buffer[MaxNumericLength];
+        auto size = detail::toStreamChars(value, buffer);
+        return std::wstring(buffer, buffer + size);
+    }
+    else
+    {
+        std::wstringstream ss;
+        ss << value;
+        return ss.str();
+    }
 }
 
+namespace detail
+{
+
+template <typename T, typename = void>
+struct has_reserve : std::false_type
+{
+};
+
 template <typename T>
-inline std::wstring toWstring(T numeric)
+struct has_reserve<T, std::void_t<decltype(std::declval<T&>().reserve(size_t()))>> : std::true_type
+{
+};
+
+#if FMT_VERSION >= 80000
+template <typename T>
+inline constexpr bool is_formattable_v = fmt::is_formattable<T>::value;
+#else
+// older fmt versions format every streamable type through fmt/ostream.h
+template <typename T>
+inline constexpr bool is_formattable_v = is_streamable_v<T>;
+#endif
+
+template <typename Output>
+void append(Output& output, std::string_view str)
 {
-    std::wstringstream ss;
-    ss << numeric;
-    return ss.str();
+    if constexpr (std::is_same_v<Output, std::string>)
+    {
+        output.append(str);
+    }
+    else
+    {
+        output.append(str.data(), str.data() + str.size());
+    }
+}
+
+template <typename Output, typename T>
+void append_item(Output& output, const T& item)
+{
+    if constexpr (can_cast_to_string_view_v<T>)
+    {
+        append(output, static_cast<std::string_view>(item));
+    }
+    else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+    {
+        auto c = static_cast<char>(item);
+        append(output, std::string_view(&c, 1));
+    }
+    else if constexpr (std::is_same_v<T, bool>)
+    {
+        append(output, item ? std::string_view("1") : std::string_view("0"));
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+        char buffer[MaxNumericLength];
+        append(output, std::string_view(buffer, toStreamChars(item, buffer)));
+    }
+    else if constexpr (is_formattable_v<T>)
+    {
+#if FMT_VERSION >= 50000
+        fmt::format_to(std::back_inserter(output), "{}", item);
+#else
+        append(output, fmt::format("{}", item));
+#endif
+    }
+    else
+    {
+        std::ostringstream ss;
+        ss << item;
+        append(output, ss.str());
+    }
+}
+
+}
+
+// Appends the items of a range separated by joinString to output
+// Works with any input range, including the lazy split_range, e.g.:
+//   join_into(result, split_range(line, ','), ";")
+// The output can be an std::string or a buffer with an append(begin, end) member (e.g. fmt::memory_buffer)
+// Items that are not convertible to string_view are formatted with fmt, numbers and characters
+// give the same result as streaming them, types that fmt can not format are streamed
+template <typename Output, typename Range>
+void join_into(Output& output, const Range& items, std::string_view joinString)
+{
+    using ValueType = std::decay_t<decltype(*std::begin(items))>;
+    static_assert(can_cast_to_string_view_v<ValueType> || std::is_arithmetic_v<ValueType> || detail::is_formattable_v<ValueType> || is_streamable_v<ValueType>,
+        "Items to join should be formattable, streamable or convertible to string_view");
+
+    using IteratorCategory = typename std::iterator_traits<decltype(std::begin(items))>::iterator_category;
+    if constexpr (can_cast_to_string_view_v<ValueType> && detail::has_reserve<Output>::value &&
+                  std::is_base_of_v<std::forward_iterator_tag, IteratorCategory>)
+    {
+        // the range can be traversed twice: reserve the exact size up front
+        size_t count      = 0;
+        size_t resultSize = 0;
+        for (auto& item : items)
+        {
+            resultSize += static_cast<std::string_view>(item).size();
+            ++count;
+        }
+
+        if (count > 0)
+        {
+            output.reserve(output.size() + resultSize + ((count - 1) * joinString.size()));
+        }
+    }
+
+    bool first = true;
+    for (auto&& item : items)
+    {
+        if (!first)
+        {
+            detail::append(output, joinString);
+        }
+
+        detail::append_item(output, item);
+        first = false;
+    }
+}
+
+// Join implementation for objects where the tostring implementation is provided as a callable
+template <typename Output, typename Range, typename ToStringCb>
+void join_into(Output& output, const Range& items, std::string_view joinString, ToStringCb&& cb)
+{
+    bool first = true;
+    for (auto&& item : items)
+    {
+        if (!first)
+        {
+            detail::append(output, joinString);
+        }
+
+        detail::append_item(output, cb(item));
+        first = false;
+    }
+}
+
+// Join items in the container with the provided join string
+// e.g.: join(std::vector<std::string>({"one", "two"}), ", ") == "one, two"
+template <typename Range>
+std::string join(const Range& items, std::string_view joinString)
+{
+    std::string result;
+    join_into(result, items, joinString);
+    return result;
+}
+
+template <typename Range, typename ToStringCb>
+std::string join(const Range& items, std::string_view joinString, ToStringCb&& cb)
+{
+    std::string result;
+    join_into(result, items, joinString, std::forward<ToStringCb>(cb));
+    return result;
 }
 } // namespace str
 } // namespace utils
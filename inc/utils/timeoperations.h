@@ -22,8 +22,13 @@
 #include <thread>
 #include <iomanip>
 #include <sstream>
+#include <cstring>
 #include <ctime>
 
+#if defined(__linux__)
+    #include <time.h>
+#endif
+
 namespace utils
 {
 namespace timeops
@@ -46,11 +51,10 @@ namespace timeops
         std::this_thread::sleep_for(duration);
     }
 
-    inline std::string getTimeString()
+    inline std::string getTimeString(std::chrono::system_clock::time_point t)
     {
         using namespace std::chrono;
         
-        const auto t        = system_clock::now();
         time_t time         = system_clock::to_time_t(t);
         auto tRounded       = system_clock::from_time_t(time);
         const tm timePtr    = *std::localtime(&time);
@@ -66,6 +70,120 @@ namespace timeops
         ss << timeString << std::setw(3) << std::setfill('0') << duration_cast<milliseconds>(t - tRounded).count();
         return ss.str();
     }
+
+    inline std::string getTimeString()
+    {
+        return getTimeString(std::chrono::system_clock::now());
+    }
+
+    enum class TimePrecision
+    {
+        Milliseconds,
+        Microseconds
+    };
+
+    // Writes "HH:MM:SS.mmm" or "HH:MM:SS.uuuuuu" to buffer (no terminating zero) and returns the number
+    // of characters written, buffer needs room for at least 15 characters.
+    // The "HH:MM:SS" part is cached per thread, so the expensive localtime call happens
+    // at most once per second per thread, otherwise only the fraction digits are written.
+    inline size_t formatTime(std::chrono::system_clock::time_point t, char* buffer, TimePrecision precision = TimePrecision::Milliseconds)
+    {
+        using namespace std::chrono;
+
+        struct SecondCache
+        {
+            time_t  second = -1;
+            char    text[8];
+        };
+
+        thread_local SecondCache cache;
+
+        auto sinceEpoch = duration_cast<microseconds>(t.time_since_epoch()).count();
+        auto seconds    = sinceEpoch / 1000000;
+        auto fraction   = sinceEpoch % 1000000;
+        if (fraction < 0)
+        {
+            --seconds;
+            fraction += 1000000;
+        }
+
+        auto time = static_cast<time_t>(seconds);
+        if (time != cache.second)
+        {
+            tm localTime;
+#ifdef WIN32
+            localtime_s(&localTime, &time);
+#else
+            localtime_r(&time, &localTime);
+#endif
+            char timeString[16];
+            std::strftime(timeString, sizeof(timeString), "%H:%M:%S", &localTime);
+            std::memcpy(cache.text, timeString, sizeof(cache.text));
+            cache.second = time;
+        }
+
+        std::memcpy(buffer, cache.text, sizeof(cache.text));
+        buffer[8] = '.';
+
+        int digits = 6;
+        if (precision == TimePrecision::Milliseconds)
+        {
+            digits = 3;
+            fraction /= 1000;
+        }
+
+        for (int i = 8 + digits; i > 8; --i)
+        {
+            buffer[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+
+        return 9 + digits;
+    }
+
+    // Clocks that read the time of the last scheduler tick (a few milliseconds resolution)
+    // instead of querying the hardware, which makes them considerably cheaper on Linux.
+    // On other platforms they fall back to the standard clocks.
+    struct coarse_system_clock
+    {
+        using duration                  = std::chrono::system_clock::duration;
+        using rep                       = duration::rep;
+        using period                    = duration::period;
+        using time_point                = std::chrono::system_clock::time_point;
+        static constexpr bool is_steady = false;
+
+        static time_point now() noexcept
+        {
+#if defined(__linux__) && defined(CLOCK_REALTIME_COARSE)
+            timespec ts;
+            clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+            return time_point(std::chrono::duration_cast<duration>(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+#else
+            return std::chrono::system_clock::now();
+#endif
+        }
+    };
+
+    struct coarse_steady_clock
+    {
+        using duration                  = std::chrono::steady_clock::duration;
+        using rep                       = duration::rep;
+        using period                    = duration::period;
+        using time_point                = std::chrono::steady_clock::time_point;
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept
+        {
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+            // std::chrono::steady_clock uses CLOCK_MONOTONIC so the time points are comparable
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+            return time_point(std::chrono::duration_cast<duration>(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+#else
+            return std::chrono::steady_clock::now();
+#endif
+        }
+    };
 }
 }
 
@@ -58,4 +58,23 @@ public:
 template <typename T>
 inline constexpr bool is_streamable_v = is_streamable<T>::value;
 
+// True when called during constant evaluation, lets constexpr functions pick
+// a vectorized runtime implementation when they are not evaluated at compile time
+constexpr bool is_constant_evaluated() noexcept
+{
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+    return __builtin_is_constant_evaluated();
+#elif defined(__has_builtin)
+    #if __has_builtin(__builtin_is_constant_evaluated)
+    return __builtin_is_constant_evaluated();
+    #else
+    return false;
+    #endif
+#else
+    return false;
+#endif
+}
+
 } // namespace utils
@@ -0,0 +1,44 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+namespace str
+{
+
+// True when str is well-formed UTF-8: overlong encodings, surrogates (U+D800 - U+DFFF),
+// code points above U+10FFFF and truncated sequences are rejected
+bool is_valid_utf8(std::string_view str) noexcept;
+
+// Number of code points in the UTF-8 string
+// Every byte that is not a continuation byte is counted, so the result is only meaningful for valid input
+size_t utf8_length(std::string_view str) noexcept;
+
+// Transcoding between UTF-8, UTF-16 and UTF-32
+// The input is validated first, std::invalid_argument is thrown for malformed input
+// (invalid UTF-8, unpaired surrogates, code points above U+10FFFF)
+std::u16string utf8_to_utf16(std::string_view str);
+std::u32string utf8_to_utf32(std::string_view str);
+std::string utf16_to_utf8(std::u16string_view str);
+std::string utf32_to_utf8(std::u32string_view str);
+
+}
+}
@@ -1,4 +1,4 @@
-//    Copyright (C) 2009 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
 //
 //    This program is free software; you can redistribute it and/or modify
 //    it under the terms of the GNU General Public License as published by
@@ -15,39 +15,227 @@
 //    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "utils/bufferedreader.h"
+#include "utils/workerthread.h"
 
-#include <cassert>
 #include <cstring>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <stdexcept>
 
 namespace utils
 {
 
-BufferedReader::BufferedReader(std::unique_ptr<utils::IReader> reader, size_t bufferSize)
+namespace
+{
+
+// Keeps reading until the buffer is full, readers can return less data than requested
+uint64_t readFully(IReader& reader, uint8_t* pData, uint64_t size)
+{
+    uint64_t bytes = 0;
+    while (bytes < size)
+    {
+        auto read = reader.read(pData + bytes, size - bytes);
+        if (read == 0)
+        {
+            break;
+        }
+
+        bytes += read;
+    }
+
+    return bytes;
+}
+
+}
+
+// Reads the blocks that follow the buffer of the BufferedReader on a worker thread
+// While blocks are pending the wrapped reader is only used by the worker thread,
+// cancel has to be called before the reader is used directly.
+class BufferedReader::ReadAhead
+{
+public:
+    ReadAhead(IReader& reader, size_t bufferSize, uint32_t bufferCount)
+    : m_reader(reader)
+    {
+        for (uint32_t i = 0; i < bufferCount; ++i)
+        {
+            m_freeBuffers.emplace_back(bufferSize);
+        }
+
+        m_worker.start();
+    }
+
+    ~ReadAhead()
+    {
+        cancel();
+        m_worker.stop();
+    }
+
+    bool contains(uint64_t position)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return !m_pending.empty() && m_pending.front()->position == position;
+    }
+
+    // Swaps the block at position with the buffer, returns false when the block was not read ahead
+    bool take(uint64_t position, std::vector<uint8_t>& buffer, uint64_t& length)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_pending.empty() || m_pending.front()->position != position)
+        {
+            return false;
+        }
+
+        auto& front = m_pending.front();
+        m_condition.wait(lock, [&front] () { return front->done; });
+
+        auto block = std::move(front);
+        m_pending.pop_front();
+
+        std::swap(buffer, block->data);
+        length = block->length;
+        m_freeBuffers.push_back(std::move(block->data));
+
+        if (block->error)
+        {
+            std::rethrow_exception(block->error);
+        }
+
+        return true;
+    }
+
+    // Reads the blocks starting at position until depth blocks are pending
+    void schedule(uint64_t position, uint32_t depth, uint64_t contentLength)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (m_pending.size() < depth && !m_freeBuffers.empty())
+        {
+            auto next = m_pending.empty() ? position : m_pending.back()->position + m_pending.back()->data.size();
+            if (next >= contentLength)
+            {
+                break;
+            }
+
+            auto block = std::make_unique<Block>();
+            block->position = next;
+            block->data = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+
+            auto* pBlock = block.get();
+            m_pending.push_back(std::move(block));
+            m_worker.addJob([this, pBlock] () { readBlock(*pBlock); });
+        }
+    }
+
+    // Drops the pending blocks, blocks that are being read are waited for
+    void cancel()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (auto& block : m_pending)
+        {
+            block->cancelled = true;
+        }
+
+        m_condition.wait(lock, [this] () {
+            return std::all_of(m_pending.begin(), m_pending.end(), [] (auto& block) { return block->done; });
+        });
+
+        for (auto& block : m_pending)
+        {
+            m_freeBuffers.push_back(std::move(block->data));
+        }
+
+        m_pending.clear();
+    }
+
+private:
+    struct Block
+    {
+        std::vector<uint8_t>    data;
+        uint64_t                position = 0;
+        uint64_t                length = 0;
+        bool                    done = false;
+        bool                    cancelled = false;
+        std::exception_ptr      error;
+    };
+
+    void readBlock(Block& block)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (block.cancelled)
+            {
+                block.done = true;
+                m_condition.notify_all();
+                return;
+            }
+        }
+
+        uint64_t length = 0;
+        std::exception_ptr error;
+
+        try
+        {
+            m_reader.seekAbsolute(block.position);
+            length = readFully(m_reader, block.data.data(), block.data.size());
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        block.length = length;
+        block.error = error;
+        block.done = true;
+        m_condition.notify_all();
+    }
+
+    IReader&                                m_reader;
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_condition;
+    std::deque<std::unique_ptr<Block>>      m_pending;
+    std::vector<std::vector<uint8_t>>       m_freeBuffers;
+    WorkerThread                            m_worker;
+};
+
+BufferedReader::BufferedReader(std::unique_ptr<utils::IReader> reader, size_t bufferSize, uint32_t readAheadBuffers)
 : m_reader(std::move(reader))
 , m_buffer(bufferSize, '\0')
 , m_bufferStartPosition(0)
-, m_bufferOffset(0)
+, m_bufferLength(0)
 , m_currentPosition(0)
 , m_contentLength(0)
-, m_bufferFilled(false)
+, m_readAheadBuffers(readAheadBuffers)
+, m_sequentialRefills(0)
 {
+    if (m_readAheadBuffers > 0)
+    {
+        m_readAhead = std::make_unique<ReadAhead>(*m_reader, bufferSize, m_readAheadBuffers);
+    }
 }
 
+BufferedReader::~BufferedReader() = default;
+
 void BufferedReader::open(const std::string& filename)
 {
+    cancelReadAhead();
+
     m_reader->open(filename);
     m_contentLength = m_reader->getContentLength();
     m_bufferStartPosition = 0;
+    m_bufferLength = 0;
     m_currentPosition = 0;
-    m_bufferOffset = 0;
-    m_bufferFilled = false;
+    m_sequentialRefills = 0;
 }
 
 void BufferedReader::close()
 {
+    cancelReadAhead();
     m_reader->close();
+    m_bufferLength = 0;
 }
 
 uint64_t BufferedReader::getContentLength()
@@ -62,12 +250,12 @@ uint64_t BufferedReader::currentPosition()
 
 void BufferedReader::seekAbsolute(uint64_t position)
 {
-    updateOffsetsAfterSeek(position);
+    m_currentPosition = position;
 }
 
 void BufferedReader::seekRelative(uint64_t offset)
 {
-    updateOffsetsAfterSeek(m_currentPosition + offset);
+    m_currentPosition += offset;
 }
 
 bool BufferedReader::eof()
@@ -82,129 +270,144 @@ std::string BufferedReader::uri()
 
 uint64_t BufferedReader::read(uint8_t* pData, uint64_t size)
 {
-    if (!m_bufferFilled)
-    {
-        if (size < m_buffer.size())
-        {
-            m_reader->seekAbsolute(m_currentPosition);
-            auto read = m_reader->read(m_buffer.data(), m_buffer.size());
-
-            if (read > 0)
-            {
-                auto advance = std::min(read, size);
-
-                memcpy(pData, m_buffer.data(), size);
-                m_bufferStartPosition = m_currentPosition;
-                m_bufferFilled = true;
-                m_currentPosition += advance;
-                m_bufferOffset = advance;
-                return advance;
-            }
-            else
-            {
-                return read;
-            }
-        }
-        else
-        {
-            // requested data larger then buffer, read directly
-            m_reader->seekAbsolute(m_currentPosition);
-            m_currentPosition = m_reader->read(pData, size);
-            return size;
-        }
-    }
-    else
+    uint64_t bytesRead = 0;
+    while (bytesRead < size)
     {
-        auto bytesInBuffer = m_buffer.size() - m_bufferOffset;
-
-        if (size < bytesInBuffer)
-        {
-            // sufficient data in the buffer
-            memcpy(pData, &m_buffer[m_bufferOffset], size);
-            m_currentPosition += size;
-            m_bufferOffset += size;
-
-            return size;
-        }
-        else
+        if (!bufferContains(m_currentPosition))
         {
-            // first copy the existing data from the buffer
-            memcpy(pData, &m_buffer[m_bufferOffset], bytesInBuffer);
-            m_currentPosition += bytesInBuffer;
-
-            // we are going to make a read, make sure the read pointer is ok
-            m_reader->seekAbsolute(m_currentPosition);
-
-            if (size - bytesInBuffer < m_buffer.size())
+            auto remaining = size - bytesRead;
+            if (remaining >= m_buffer.size() && !(m_readAhead && m_readAhead->contains(m_currentPosition)))
             {
-                // one bufferfill is sufficient to provide the data
-
-                // fill the buffer with fresh data
-                auto read = m_reader->read(m_buffer.data(), m_buffer.size());
-                auto bytesToRead = std::min(read, size - bytesInBuffer);
-
-                if (bytesToRead > 0)
+                // requested data larger then buffer, read directly
+                cancelReadAhead();
+                m_reader->seekAbsolute(m_currentPosition);
+                auto read = m_reader->read(pData + bytesRead, remaining);
+                if (read == 0)
                 {
-                    // copy the reaming data from the buffer
-                    memcpy(pData + bytesInBuffer, m_buffer.data(), bytesToRead);
-
-                    m_bufferStartPosition = m_currentPosition;
-                    m_currentPosition += bytesToRead;
-                    m_bufferOffset = bytesToRead;
-
-                    assert(m_bufferOffset <= m_buffer.size());
-                    if (m_bufferOffset == m_buffer.size())
-                    {
-                        // buffer was completely emptied, mark it as not filled
-                        m_bufferFilled = false;
-                    }
-                }
-                else
-                {
-                    // buffer is not filled as we could not obtain extra data
-                    m_bufferFilled = false;
+                    break;
                 }
 
-                return bytesInBuffer + bytesToRead;
-            }
-            else
-            {
-                // rest of the data is larger then 1 buffer so read it directly
-                auto read = m_reader->read(pData + bytesInBuffer, size - bytesInBuffer);
                 m_currentPosition += read;
-                m_bufferFilled = false;
+                bytesRead += read;
+                continue;
+            }
 
-                return read + bytesInBuffer;
+            if (!refillBuffer())
+            {
+                break;
             }
         }
+
+        auto offset = m_currentPosition - m_bufferStartPosition;
+        auto bytes = std::min(size - bytesRead, m_bufferLength - offset);
+        memcpy(pData + bytesRead, m_buffer.data() + offset, bytes);
+
+        m_currentPosition += bytes;
+        bytesRead += bytes;
     }
+
+    return bytesRead;
 }
 
 std::vector<uint8_t> BufferedReader::readAllData()
 {
+    cancelReadAhead();
     m_currentPosition = m_contentLength;
     return m_reader->readAllData();
 }
 
 void BufferedReader::clearErrors()
 {
+    cancelReadAhead();
     m_reader->clearErrors();
 }
 
-void BufferedReader::updateOffsetsAfterSeek(uint64_t newPosition)
+ByteSpan BufferedReader::peek(uint64_t size)
 {
-    if (m_bufferFilled && (newPosition >= m_bufferStartPosition && newPosition < (m_bufferStartPosition + m_buffer.size())))
+    if (size > m_buffer.size())
     {
-        // seek is in the buffer range, update the offset
-        m_bufferOffset = newPosition - m_bufferStartPosition;
+        cancelReadAhead();
+        m_reader->seekAbsolute(m_currentPosition);
+        return m_reader->peek(size);
+    }
+
+    if (!bufferContains(m_currentPosition) && !refillBuffer())
+    {
+        return ByteSpan();
+    }
+
+    auto offset = m_currentPosition - m_bufferStartPosition;
+    auto available = m_bufferLength - offset;
+    auto bufferEnd = m_bufferStartPosition + m_bufferLength;
+    if (available >= size || bufferEnd >= m_contentLength)
+    {
+        return ByteSpan{m_buffer.data() + offset, std::min(size, available)};
+    }
+
+    // the data continues in the next block, the consume that follows moves the position into it
+    m_spanBuffer.assign(m_buffer.begin() + offset, m_buffer.begin() + m_bufferLength);
+
+    auto position = m_currentPosition;
+    m_currentPosition = bufferEnd;
+    try
+    {
+        if (refillBuffer())
+        {
+            auto bytes = std::min(size - available, m_bufferLength);
+            m_spanBuffer.insert(m_spanBuffer.end(), m_buffer.begin(), m_buffer.begin() + bytes);
+        }
+    }
+    catch (...)
+    {
+        m_currentPosition = position;
+        throw;
+    }
+
+    m_currentPosition = position;
+    return ByteSpan{m_spanBuffer.data(), m_spanBuffer.size()};
+}
+
+bool BufferedReader::bufferContains(uint64_t position) const noexcept
+{
+    return position >= m_bufferStartPosition && position < m_bufferStartPosition + m_bufferLength;
+}
+
+// Fills the buffer with the data at the current position, returns false when there is no more data
+bool BufferedReader::refillBuffer()
+{
+    if (m_currentPosition == m_bufferStartPosition + m_bufferLength)
+    {
+        m_sequentialRefills = std::min(m_sequentialRefills + 1, m_readAheadBuffers);
     }
     else
     {
-        // seek is not in the buffer range, so buffer is not valid
-        m_bufferFilled = false;
+        m_sequentialRefills = 0;
+    }
+
+    m_bufferStartPosition = m_currentPosition;
+    m_bufferLength = 0;
+
+    if (!m_readAhead || !m_readAhead->take(m_currentPosition, m_buffer, m_bufferLength))
+    {
+        cancelReadAhead();
+        m_reader->seekAbsolute(m_currentPosition);
+        m_bufferLength = readFully(*m_reader, m_buffer.data(), m_buffer.size());
     }
 
-    m_currentPosition = newPosition;
+    if (m_readAhead)
+    {
+        m_readAhead->schedule(m_bufferStartPosition + m_bufferLength, m_sequentialRefills, m_contentLength);
+    }
+
+    return m_bufferLength > 0;
+}
+
+void BufferedReader::cancelReadAhead()
+{
+    if (m_readAhead)
+    {
+        m_readAhead->cancel();
+    }
 }
 
 }
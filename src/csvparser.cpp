@@ -0,0 +1,314 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "utils/csvparser.h"
+#include "utils/readerinterface.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace utils
+{
+namespace str
+{
+
+csv_parser::csv_parser(IReader& reader, csv_options options)
+: m_reader(&reader)
+, m_options(options)
+, m_equalAnyMask(simd::equalAnyMaskFunction())
+{
+}
+
+csv_parser::csv_parser(std::string_view data, csv_options options)
+: m_options(options)
+, m_data(data.data())
+, m_size(data.size())
+, m_eof(true)
+, m_equalAnyMask(simd::equalAnyMaskFunction())
+{
+}
+
+bool csv_parser::read_row()
+{
+    for (;;)
+    {
+        switch (parseRow())
+        {
+        case ParseResult::Row:
+            // the unescaped fields can only be pointed to when the row is complete
+            for (auto& field : m_unescapedFields)
+            {
+                m_fields[field.index] = std::string_view(m_unescaped.data() + field.offset, field.size);
+            }
+
+            ++m_rowCount;
+            return true;
+        case ParseResult::End:
+            m_fields.clear();
+            return false;
+        case ParseResult::NeedMoreData:
+            if (!refill())
+            {
+                // whatever is left in the buffer is the last row
+                m_eof = true;
+            }
+            break;
+        }
+    }
+}
+
+bool csv_parser::refill()
+{
+    if (m_reader == nullptr)
+    {
+        return false;
+    }
+
+    // keep the unfinished row, the parsing restarts at its beginning
+    size_t remaining = m_size - m_pos;
+    if (m_pos > 0 && remaining > 0)
+    {
+        std::memmove(m_buffer.data(), m_buffer.data() + m_pos, remaining);
+    }
+
+    if (m_buffer.size() - remaining < m_options.chunkSize)
+    {
+        m_buffer.resize(std::max(m_buffer.size() * 2, remaining + m_options.chunkSize));
+    }
+
+    auto bytesRead = m_reader->read(reinterpret_cast<uint8_t*>(m_buffer.data() + remaining), m_buffer.size() - remaining);
+
+    m_data     = m_buffer.data();
+    m_size     = remaining + static_cast<size_t>(bytesRead);
+    m_pos      = 0;
+    m_maskBase = SIZE_MAX;
+    return bytesRead > 0;
+}
+
+uint64_t csv_parser::structuralMask(size_t pos) const noexcept
+{
+    // without quoting the delimiter is passed twice instead of the quote
+    const char quote = m_options.quoting ? m_options.quote : m_options.delimiter;
+
+    if (pos + simd::BlockSize <= m_size)
+    {
+        return m_equalAnyMask(m_data + pos, m_options.delimiter, '\n', '\r', quote);
+    }
+
+    uint64_t mask = 0;
+    for (size_t i = 0; pos + i < m_size; ++i)
+    {
+        auto c = m_data[pos + i];
+        if (c == m_options.delimiter || c == '\n' || c == '\r' || c == quote)
+        {
+            mask |= uint64_t(1) << i;
+        }
+    }
+
+    return mask;
+}
+
+inline size_t csv_parser::nextStructural(size_t pos, size_t& maskBase, uint64_t& mask) const noexcept
+{
+    // the masks are calculated per aligned block so consecutive fields and rows reuse them
+    size_t base = pos - (pos % simd::BlockSize);
+    if (base != maskBase)
+    {
+        maskBase = base;
+        mask     = structuralMask(base);
+    }
+
+    auto remaining = mask & (~uint64_t(0) << (pos - base));
+    while (remaining == 0)
+    {
+        base += simd::BlockSize;
+        if (base >= m_size)
+        {
+            return m_size;
+        }
+
+        maskBase  = base;
+        mask      = structuralMask(base);
+        remaining = mask;
+    }
+
+    return base + simd::countTrailingZeros(remaining);
+}
+
+csv_parser::ParseResult csv_parser::parseRow()
+{
+    m_fields.clear();
+    m_unescapedFields.clear();
+    m_unescaped.clear();
+
+    // local copies: the compiler can not keep members in registers across the push_backs
+    const char* data     = m_data;
+    const size_t size    = m_size;
+    const bool eof       = m_eof;
+    const bool quoting   = m_options.quoting;
+    const char quote     = m_options.quote;
+    const char delimiter = m_options.delimiter;
+    size_t maskBase      = m_maskBase;
+    uint64_t mask        = m_mask;
+
+    // skip empty lines
+    size_t pos = m_pos;
+    while (pos < size && (data[pos] == '\n' || data[pos] == '\r'))
+    {
+        ++pos;
+    }
+
+    m_pos = pos;
+    if (pos == size)
+    {
+        return eof ? ParseResult::End : ParseResult::NeedMoreData;
+    }
+
+    // end of the field: the next delimiter or newline, quotes in the middle of a field are regular characters
+    auto fieldEnd = [&](size_t fieldPos) {
+        auto end = nextStructural(fieldPos, maskBase, mask);
+        while (quoting && end < size && data[end] == quote)
+        {
+            end = nextStructural(end + 1, maskBase, mask);
+        }
+
+        return end;
+    };
+
+    for (;;)
+    {
+        if (quoting && data[pos] == quote)
+        {
+            size_t contentStart = pos + 1;
+            size_t closing      = contentStart;
+            bool escaped        = false;
+
+            for (;;)
+            {
+                auto* next = static_cast<const char*>(std::memchr(data + closing, quote, size - closing));
+                if (next == nullptr)
+                {
+                    if (!eof)
+                    {
+                        return ParseResult::NeedMoreData;
+                    }
+
+                    // unterminated quote: the field is the rest of the data
+                    closing = size;
+                    break;
+                }
+
+                closing = static_cast<size_t>(next - data);
+                if (closing + 1 == size && !eof)
+                {
+                    // the next chunk could start with a quote
+                    return ParseResult::NeedMoreData;
+                }
+
+                if (closing + 1 < size && data[closing + 1] == quote)
+                {
+                    escaped = true;
+                    closing += 2;
+                    continue;
+                }
+
+                break;
+            }
+
+            pos      = std::min(closing + 1, size);
+            auto end = fieldEnd(pos);
+            if (end == size && !eof)
+            {
+                return ParseResult::NeedMoreData;
+            }
+
+            if (escaped || end != pos)
+            {
+                auto offset = m_unescaped.size();
+                for (size_t i = contentStart; i < closing; ++i)
+                {
+                    m_unescaped += data[i];
+                    if (data[i] == quote)
+                    {
+                        // skip the second quote of the escaped pair
+                        ++i;
+                    }
+                }
+
+                m_unescaped.append(data + pos, end - pos);
+                m_unescapedFields.push_back({m_fields.size(), offset, m_unescaped.size() - offset});
+                m_fields.emplace_back();
+            }
+            else
+            {
+                m_fields.emplace_back(data + contentStart, closing - contentStart);
+            }
+
+            pos = end;
+        }
+        else
+        {
+            auto end = fieldEnd(pos);
+            if (end == size && !eof)
+            {
+                return ParseResult::NeedMoreData;
+            }
+
+            m_fields.emplace_back(data + pos, end - pos);
+            pos = end;
+        }
+
+        if (pos == size)
+        {
+            break;
+        }
+
+        if (data[pos] == delimiter)
+        {
+            if (++pos == size)
+            {
+                if (!eof)
+                {
+                    return ParseResult::NeedMoreData;
+                }
+
+                // trailing delimiter: the last field is empty
+                m_fields.emplace_back(data + pos, 0);
+                break;
+            }
+
+            continue;
+        }
+
+        // end of the row, a \n following a \r is skipped as an empty line by the next row
+        ++pos;
+        if (pos < size && data[pos - 1] == '\r' && data[pos] == '\n')
+        {
+            ++pos;
+        }
+
+        break;
+    }
+
+    m_pos      = pos;
+    m_maskBase = maskBase;
+    m_mask     = mask;
+    return ParseResult::Row;
+}
+
+}
+}
@@ -16,6 +16,7 @@
 
 #include "utils/filereader.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace utils
@@ -24,6 +25,8 @@ namespace utils
 void FileReader::open(const std::string& filename)
 {
     m_fileName = filename;
+    m_windowSize = 0;
+    m_windowAtEnd = false;
     m_file.open(filename.c_str(), std::ios::binary);
 
     if (!m_file.is_open())
@@ -109,4 +112,34 @@ void FileReader::clearErrors()
     m_file.clear();
 }
 
+ByteSpan FileReader::peek(uint64_t size)
+{
+    static const uint64_t minimumWindowSize = 64 * 1024;
+
+    if (eof())
+    {
+        clearErrors();
+    }
+
+    uint64_t position = m_file.tellg();
+    auto windowEnd = m_windowPosition + m_windowSize;
+
+    // a window that reaches the end of the file also covers requests that extend past it
+    bool covered = position >= m_windowPosition && position <= windowEnd && (position + size <= windowEnd || m_windowAtEnd);
+    if (!covered)
+    {
+        m_window.resize(std::max<uint64_t>({size, minimumWindowSize, m_window.size()}));
+        m_file.read(reinterpret_cast<char*>(m_window.data()), m_window.size());
+        m_windowPosition = position;
+        m_windowSize = m_file.gcount();
+        m_windowAtEnd = m_windowSize < m_window.size();
+
+        clearErrors();
+        m_file.seekg(position);
+    }
+
+    auto offset = position - m_windowPosition;
+    return ByteSpan{m_window.data() + offset, std::min(size, m_windowSize - offset)};
+}
+
 }
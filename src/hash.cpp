@@ -0,0 +1,113 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "utils/hash.h"
+#include "utils/readerinterface.h"
+
+#include <cstring>
+#include <vector>
+
+namespace utils
+{
+namespace hash
+{
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed) noexcept
+{
+    return detail::hash64(static_cast<const char*>(data), size, seed);
+}
+
+uint64_t hash64(IReader& reader, uint64_t seed)
+{
+    Hasher hasher(seed);
+
+    // peek avoids the copy for readers that can hand out their buffer or mapping
+    for (auto data = reader.peek(64 * 1024); !data.empty(); data = reader.peek(64 * 1024))
+    {
+        hasher.update(data.data, static_cast<size_t>(data.size));
+        reader.consume(data.size);
+    }
+
+    return hasher.digest();
+}
+
+Hasher::Hasher(uint64_t seed) noexcept
+{
+    reset(seed);
+}
+
+void Hasher::reset(uint64_t seed) noexcept
+{
+    m_seed     = detail::initialSeed(seed);
+    m_lanes[0] = m_seed;
+    m_lanes[1] = m_seed;
+    m_size     = 0;
+    m_pending  = 0;
+}
+
+void Hasher::update(const void* data, size_t size) noexcept
+{
+    auto* bytes   = static_cast<const char*>(data);
+    auto* pending = m_buffer.data() + HistorySize;
+    m_size += size;
+
+    // a stripe is only processed when more data follows, the last bytes are handled by digest
+    if (m_pending + size <= StripeSize)
+    {
+        std::memcpy(pending + m_pending, bytes, size);
+        m_pending += size;
+        return;
+    }
+
+    auto fill = StripeSize - m_pending;
+    std::memcpy(pending + m_pending, bytes, fill);
+    detail::processStripe(pending, m_seed, m_lanes[0], m_lanes[1]);
+    bytes += fill;
+    size -= fill;
+
+    const char* lastStripe = pending;
+    while (size > StripeSize)
+    {
+        detail::processStripe(bytes, m_seed, m_lanes[0], m_lanes[1]);
+        lastStripe = bytes;
+        bytes += StripeSize;
+        size -= StripeSize;
+    }
+
+    std::memcpy(m_buffer.data(), lastStripe + StripeSize - HistorySize, HistorySize);
+    std::memcpy(pending, bytes, size);
+    m_pending = size;
+}
+
+uint64_t Hasher::digest() const noexcept
+{
+    auto* pending = m_buffer.data() + HistorySize;
+    if (m_size <= 16)
+    {
+        return detail::hashShort(pending, m_pending, m_seed);
+    }
+
+    auto seed = m_seed;
+    if (m_size > StripeSize)
+    {
+        seed ^= m_lanes[0] ^ m_lanes[1];
+    }
+
+    return detail::hashRemaining(pending, m_pending, seed, m_size);
+}
+
+}
+}
@@ -15,11 +15,360 @@
 //    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "utils/log.h"
+#include "utils/logsink.h"
+#include "utils/boundedqueue.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 
 namespace utils
 {
 
-log::Level log::m_level = log::Level::Debug;
+struct log::Record
+{
+    Level                                   level = Level::Info;
+    std::chrono::system_clock::time_point   timestamp;
+    std::thread::id                         threadId;
+    std::string                             message;
+
+    // only used for deferred formatting, format points to a string literal
+    DeferredFormatter                       formatter = nullptr;
+    const char*                             format = nullptr;
+    std::array<uint8_t, MaxDeferredArgsSize> args;
+};
+
+class log::AsyncWriter
+{
+public:
+    AsyncWriter(size_t capacity, OverflowPolicy policy)
+    : m_queue(capacity)
+    , m_policy(policy)
+    , m_stop(false)
+    , m_sleeping(false)
+    , m_pushed(0)
+    , m_written(0)
+    , m_dropped(0)
+    , m_thread(&AsyncWriter::run, this)
+    {
+    }
+
+    ~AsyncWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_condition.notify_one();
+        m_thread.join();
+
+        // messages that were pushed while the writer was shutting down
+        Record record;
+        while (m_queue.tryPop(record))
+        {
+            dispatch(record);
+        }
+
+        flushSinks();
+    }
+
+    void push(Record&& record) noexcept
+    {
+        if (!m_queue.tryPush(std::move(record)))
+        {
+            if (m_policy == OverflowPolicy::Drop)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            do
+            {
+                wakeWriter();
+                std::this_thread::yield();
+            }
+            while (!m_queue.tryPush(std::move(record)));
+        }
+
+        m_pushed.fetch_add(1, std::memory_order_relaxed);
+
+        // Pairs with the fence in run(): either the writer sees the new record or we see it is sleeping
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed))
+        {
+            wakeWriter();
+        }
+    }
+
+    void flush() noexcept
+    {
+        auto target = m_pushed.load(std::memory_order_acquire);
+        while (m_written.load(std::memory_order_acquire) < target)
+        {
+            wakeWriter();
+            std::this_thread::yield();
+        }
+    }
+
+    uint64_t dropped() const noexcept
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    void wakeWriter() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_condition.notify_one();
+    }
+
+    void run()
+    {
+        Record record;
+
+        for (;;)
+        {
+            while (m_queue.tryPop(record))
+            {
+                dispatch(record);
+                m_written.fetch_add(1, std::memory_order_release);
+            }
+
+            flushSinks();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (m_queue.empty())
+            {
+                if (m_stop)
+                {
+                    break;
+                }
+
+                m_condition.wait_for(lock, std::chrono::milliseconds(100));
+            }
+
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue<Record>        m_queue;
+    OverflowPolicy              m_policy;
+    bool                        m_stop;
+    std::atomic<bool>           m_sleeping;
+    std::atomic<uint64_t>       m_pushed;
+    std::atomic<uint64_t>       m_written;
+    std::atomic<uint64_t>       m_dropped;
+
+    std::mutex                  m_mutex;
+    std::condition_variable     m_condition;
+    std::thread                 m_thread;
+};
+
+std::atomic<log::Level> log::m_level(log::Level::Debug);
+std::array<std::atomic<int>, log::MaxModules> log::m_moduleLevels;
+std::atomic<bool> log::m_deferredFormatting(false);
+std::atomic<bool> log::m_coarseTimestamps(false);
 std::mutex log::m_mutex;
+std::vector<std::shared_ptr<ILogSink>> log::m_sinks = { std::make_shared<ConsoleSink>() };
+std::unique_ptr<log::AsyncWriter> log::m_asyncWriter;
+
+namespace
+{
+
+std::mutex& moduleMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Index in the vector is the module id, slot 0 is reserved for the modules that did not fit
+std::vector<std::string>& moduleNames()
+{
+    static std::vector<std::string> names(1);
+    return names;
+}
+
+uint32_t moduleId(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(moduleMutex());
+
+    auto& names = moduleNames();
+    auto iter = std::find(names.begin() + 1, names.end(), name);
+    if (iter != names.end())
+    {
+        return static_cast<uint32_t>(iter - names.begin());
+    }
+
+    if (names.size() == log::MaxModules)
+    {
+        return 0;
+    }
+
+    names.emplace_back(name);
+    return static_cast<uint32_t>(names.size() - 1);
+}
+
+}
+
+log::Module::Module(std::string_view name)
+: m_id(moduleId(name))
+{
+}
+
+void log::setFilter(std::string_view moduleName, Level level)
+{
+    setFilter(Module(moduleName), level);
+}
+
+void log::addSink(std::shared_ptr<ILogSink> sink)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sinks.push_back(std::move(sink));
+}
+
+void log::removeSink(const std::shared_ptr<ILogSink>& sink)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sinks.erase(std::remove(m_sinks.begin(), m_sinks.end(), sink), m_sinks.end());
+}
+
+void log::clearSinks()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sinks.clear();
+}
+
+void log::enableAsync(size_t queueCapacity, OverflowPolicy policy, FormatMode formatMode)
+{
+    if (!m_asyncWriter)
+    {
+        m_asyncWriter = std::make_unique<AsyncWriter>(queueCapacity, policy);
+    }
+
+    m_deferredFormatting.store(formatMode == FormatMode::Deferred, std::memory_order_relaxed);
+}
+
+void log::disableAsync()
+{
+    m_deferredFormatting.store(false, std::memory_order_relaxed);
+    m_asyncWriter.reset();
+}
+
+void log::flush()
+{
+    if (m_asyncWriter)
+    {
+        m_asyncWriter->flush();
+    }
+
+    flushSinks();
+}
+
+uint64_t log::droppedMessages() noexcept
+{
+    return m_asyncWriter ? m_asyncWriter->dropped() : 0;
+}
+
+void log::dispatch(Record& record) noexcept
+{
+    try
+    {
+        if (record.formatter)
+        {
+            record.message = record.formatter(record.format, record.args.data());
+        }
+
+        LogMessage msg{record.level, record.timestamp, record.threadId, record.message};
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& sink : m_sinks)
+        {
+            sink->write(msg);
+        }
+    }
+    catch (const fmt::FormatError&)
+    {
+        assert(false && "Format error");
+    }
+    catch (const std::exception&)
+    {
+        assert(false && "Failed to write log message");
+    }
+}
+
+void log::flushSinks() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& sink : m_sinks)
+    {
+        try
+        {
+            sink->flush();
+        }
+        catch (const std::exception&)
+        {
+            assert(false && "Failed to flush log sink");
+        }
+    }
+}
+
+void log::write(Level level, const char* s) noexcept
+{
+    try
+    {
+        write(level, std::string(s));
+    }
+    catch (const std::bad_alloc&)
+    {
+        assert(false && "Out of memory");
+    }
+}
+
+void log::write(Level level, std::string&& s) noexcept
+{
+    Record record;
+    record.level     = level;
+    record.timestamp = m_coarseTimestamps.load(std::memory_order_relaxed) ? timeops::coarse_system_clock::now() : std::chrono::system_clock::now();
+    record.threadId  = std::this_thread::get_id();
+    record.message   = std::move(s);
+
+    if (m_asyncWriter)
+    {
+        m_asyncWriter->push(std::move(record));
+    }
+    else
+    {
+        dispatch(record);
+    }
+}
+
+void log::writeDeferred(Level level, const char* s, DeferredFormatter formatter, const uint8_t* args, size_t size) noexcept
+{
+    assert(size <= MaxDeferredArgsSize);
+
+    Record record;
+    record.level     = level;
+    record.timestamp = m_coarseTimestamps.load(std::memory_order_relaxed) ? timeops::coarse_system_clock::now() : std::chrono::system_clock::now();
+    record.threadId  = std::this_thread::get_id();
+    record.formatter = formatter;
+    record.format    = s;
+    std::memcpy(record.args.data(), args, size);
+
+    if (m_asyncWriter)
+    {
+        m_asyncWriter->push(std::move(record));
+    }
+    else
+    {
+        dispatch(record);
+    }
+}
 
 }
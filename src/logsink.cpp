@@ -0,0 +1,336 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/logsink.h"
+#include "utils/format.h"
+
+#include <stdexcept>
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+    #include <unistd.h>
+    #include <syslog.h>
+#endif
+
+namespace utils
+{
+
+namespace
+{
+
+const char* levelName(log::Level level)
+{
+    switch (level)
+    {
+    case log::Level::Debug:     return "DEBUG";
+    case log::Level::Info:      return "INFO";
+    case log::Level::Warn:      return "WARN";
+    case log::Level::Error:     return "ERROR";
+    case log::Level::Critical:  return "CRIT";
+    }
+
+    return "";
+}
+
+fmt::Color levelColor(log::Level level)
+{
+    switch (level)
+    {
+    case log::Level::Debug:     return fmt::WHITE;
+    case log::Level::Info:      return fmt::GREEN;
+    case log::Level::Warn:      return fmt::YELLOW;
+    case log::Level::Error:     return fmt::RED;
+    case log::Level::Critical:  return fmt::MAGENTA;
+    }
+
+    return fmt::WHITE;
+}
+
+void appendLogMessage(std::string& line, const LogMessage& msg)
+{
+    line += levelName(msg.level);
+    line += ": [";
+    if (msg.level == log::Level::Debug)
+    {
+        line += fmt::format("{}", msg.threadId);
+        line += "] [";
+    }
+    char time[16];
+    line.append(time, timeops::formatTime(msg.timestamp, time));
+    line += "] ";
+    line += msg.message;
+}
+
+}
+
+std::string formatLogMessage(const LogMessage& msg)
+{
+    std::string line;
+    appendLogMessage(line, msg);
+    return line;
+}
+
+void ConsoleSink::write(const LogMessage& msg)
+{
+    fmt::print_colored(levelColor(msg.level), "{}\n", formatLogMessage(msg));
+}
+
+void ConsoleSink::flush()
+{
+    std::fflush(stdout);
+}
+
+RotatingFileSink::RotatingFileSink(const std::string& path, uint64_t maxFileSize, std::chrono::seconds rotationInterval, uint32_t maxFiles)
+: m_path(path)
+, m_maxFileSize(maxFileSize)
+, m_rotationInterval(rotationInterval)
+, m_maxFiles(maxFiles)
+, m_syncInterval(0)
+, m_file(nullptr)
+, m_fileBuffer(64 * 1024)
+, m_fileSize(0)
+, m_unsyncedData(false)
+{
+    open();
+}
+
+RotatingFileSink::~RotatingFileSink()
+{
+    close();
+}
+
+void RotatingFileSink::setSyncInterval(std::chrono::milliseconds interval)
+{
+    m_syncInterval = interval;
+}
+
+void RotatingFileSink::write(const LogMessage& msg)
+{
+    if (m_file && ((m_maxFileSize > 0 && m_fileSize >= m_maxFileSize) ||
+        (m_rotationInterval.count() > 0 && std::chrono::steady_clock::now() - m_openTime >= m_rotationInterval)))
+    {
+        rotate();
+    }
+
+    // messages are lost while the log file cannot be opened
+    if (!m_file && !reopen())
+    {
+        return;
+    }
+
+    m_line.clear();
+    appendLogMessage(m_line, msg);
+    m_line += '\n';
+
+    // the data only hits the file once the stdio buffer is full, on flush, for errors
+    // or when the sync interval expired
+    m_fileSize += std::fwrite(m_line.data(), 1, m_line.size(), m_file);
+    m_unsyncedData = true;
+
+    if (msg.level >= log::Level::Error)
+    {
+        std::fflush(m_file);
+    }
+
+    // flush() is only called by the asynchronous writer or explicitly, so check the interval here as well
+    syncIfDue();
+}
+
+void RotatingFileSink::flush()
+{
+    if (!m_file)
+    {
+        return;
+    }
+
+    std::fflush(m_file);
+    syncIfDue();
+}
+
+void RotatingFileSink::syncIfDue()
+{
+    if (m_syncInterval.count() > 0 && m_unsyncedData)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_lastSync >= m_syncInterval)
+        {
+            std::fflush(m_file);
+            sync();
+            m_lastSync = now;
+        }
+    }
+}
+
+void RotatingFileSink::sync()
+{
+#if !defined(WIN32) && !defined(__MINGW32__)
+    if (m_file)
+    {
+        fsync(fileno(m_file));
+    }
+#endif
+    m_unsyncedData = false;
+}
+
+void RotatingFileSink::open()
+{
+    m_file = std::fopen(m_path.c_str(), "ab");
+    if (!m_file)
+    {
+        throw std::runtime_error("Failed to open log file for writing: " + m_path);
+    }
+
+    std::setvbuf(m_file, m_fileBuffer.data(), _IOFBF, m_fileBuffer.size());
+
+    std::fseek(m_file, 0, SEEK_END);
+    m_fileSize = static_cast<uint64_t>(std::ftell(m_file));
+    m_openTime = std::chrono::steady_clock::now();
+    m_lastSync = m_openTime;
+}
+
+void RotatingFileSink::close()
+{
+    if (m_file)
+    {
+        std::fflush(m_file);
+        if (m_syncInterval.count() > 0 && m_unsyncedData)
+        {
+            sync();
+        }
+
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void RotatingFileSink::rotate()
+{
+    close();
+
+    if (m_maxFiles == 0)
+    {
+        std::remove(m_path.c_str());
+    }
+    else
+    {
+        std::remove(fmt::format("{}.{}", m_path, m_maxFiles).c_str());
+        for (auto i = m_maxFiles - 1; i > 0; --i)
+        {
+            std::rename(fmt::format("{}.{}", m_path, i).c_str(), fmt::format("{}.{}", m_path, i + 1).c_str());
+        }
+
+        std::rename(m_path.c_str(), fmt::format("{}.1", m_path).c_str());
+    }
+
+    // a failure to open the new file must not break the logging of the application
+    m_failedOpenTime = std::chrono::steady_clock::time_point();
+    reopen();
+}
+
+bool RotatingFileSink::reopen()
+{
+    // retry at most once per second when the file cannot be opened
+    auto now = std::chrono::steady_clock::now();
+    if (m_failedOpenTime != std::chrono::steady_clock::time_point() && now - m_failedOpenTime < std::chrono::seconds(1))
+    {
+        return false;
+    }
+
+    try
+    {
+        open();
+        m_failedOpenTime = std::chrono::steady_clock::time_point();
+        return true;
+    }
+    catch (const std::runtime_error&)
+    {
+        m_failedOpenTime = now;
+        return false;
+    }
+}
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+SyslogSink::SyslogSink(const std::string& ident)
+: m_ident(ident)
+{
+    openlog(m_ident.c_str(), LOG_PID, LOG_USER);
+}
+
+SyslogSink::~SyslogSink()
+{
+    closelog();
+}
+
+void SyslogSink::write(const LogMessage& msg)
+{
+    int priority = LOG_INFO;
+    switch (msg.level)
+    {
+    case log::Level::Debug:     priority = LOG_DEBUG; break;
+    case log::Level::Info:      priority = LOG_INFO; break;
+    case log::Level::Warn:      priority = LOG_WARNING; break;
+    case log::Level::Error:     priority = LOG_ERR; break;
+    case log::Level::Critical:  priority = LOG_CRIT; break;
+    }
+
+    syslog(priority, "%.*s", static_cast<int>(msg.message.size()), msg.message.data());
+}
+
+void SyslogSink::flush()
+{
+}
+#endif
+
+RingBufferSink::RingBufferSink(size_t capacity)
+: m_capacity(capacity)
+{
+}
+
+void RingBufferSink::write(const LogMessage& msg)
+{
+    auto line = formatLogMessage(msg);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_messages.size() == m_capacity)
+    {
+        if (m_capacity == 0)
+        {
+            return;
+        }
+
+        m_messages.pop_front();
+    }
+
+    m_messages.push_back(std::move(line));
+}
+
+void RingBufferSink::flush()
+{
+}
+
+std::vector<std::string> RingBufferSink::messages() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::vector<std::string>(m_messages.begin(), m_messages.end());
+}
+
+void RingBufferSink::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_messages.clear();
+}
+
+}
@@ -0,0 +1,217 @@
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "utils/mmapreader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace utils
+{
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+
+namespace
+{
+
+int toAdvice(AccessPattern pattern)
+{
+    switch (pattern)
+    {
+    case AccessPattern::Sequential:
+        return MADV_SEQUENTIAL;
+    case AccessPattern::Random:
+        return MADV_RANDOM;
+    case AccessPattern::WillNeed:
+        return MADV_WILLNEED;
+    case AccessPattern::Normal:
+    default:
+        return MADV_NORMAL;
+    }
+}
+
+}
+
+MmapReader::MmapReader(AccessPattern pattern)
+: m_pattern(pattern)
+, m_data(nullptr)
+, m_size(0)
+, m_position(0)
+{
+}
+
+MmapReader::~MmapReader()
+{
+    close();
+}
+
+void MmapReader::open(const std::string& filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::logic_error("Failed to open file for reading: " + filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::logic_error("Failed to obtain file size: " + filename);
+    }
+
+    m_fileName = filename;
+    m_size     = static_cast<uint64_t>(st.st_size);
+    m_position = 0;
+
+    // mapping an empty file fails, there is nothing to map anyway
+    if (m_size > 0)
+    {
+        auto* addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            ::close(fd);
+            m_size = 0;
+            throw std::logic_error("Failed to map file: " + filename);
+        }
+
+        m_data = static_cast<uint8_t*>(addr);
+    }
+
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+
+    if (m_pattern != AccessPattern::Normal)
+    {
+        advise(m_pattern);
+    }
+}
+
+void MmapReader::close()
+{
+    if (m_data)
+    {
+        munmap(m_data, m_size);
+    }
+
+    m_data     = nullptr;
+    m_size     = 0;
+    m_position = 0;
+}
+
+uint64_t MmapReader::getContentLength()
+{
+    return m_size;
+}
+
+uint64_t MmapReader::currentPosition()
+{
+    return m_position;
+}
+
+bool MmapReader::eof()
+{
+    return m_position >= m_size;
+}
+
+std::string MmapReader::uri()
+{
+    return m_fileName;
+}
+
+void MmapReader::seekAbsolute(uint64_t position)
+{
+    m_position = position;
+}
+
+void MmapReader::seekRelative(uint64_t offset)
+{
+    m_position += offset;
+}
+
+uint64_t MmapReader::read(uint8_t* pData, uint64_t size)
+{
+    auto bytes = span(m_position, size);
+    if (!bytes.empty())
+    {
+        memcpy(pData, bytes.data, bytes.size);
+        m_position += bytes.size;
+    }
+
+    return bytes.size;
+}
+
+std::vector<uint8_t> MmapReader::readAllData()
+{
+    m_position = m_size;
+    return std::vector<uint8_t>(m_data, m_data + m_size);
+}
+
+void MmapReader::clearErrors()
+{
+}
+
+ByteSpan MmapReader::peek(uint64_t size)
+{
+    return span(m_position, size);
+}
+
+ByteSpan MmapReader::data() const noexcept
+{
+    return ByteSpan{m_data, m_size};
+}
+
+ByteSpan MmapReader::span(uint64_t offset, uint64_t size) const noexcept
+{
+    if (offset >= m_size)
+    {
+        return ByteSpan();
+    }
+
+    return ByteSpan{m_data + offset, std::min(size, m_size - offset)};
+}
+
+void MmapReader::advise(AccessPattern pattern, uint64_t offset, uint64_t size)
+{
+    if (offset >= m_size)
+    {
+        return;
+    }
+
+    // madvise requires a page aligned address
+    static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    auto alignedOffset = offset - (offset % pageSize);
+    auto end = (size == 0) ? m_size : std::min(m_size, offset + size);
+
+    if (madvise(m_data + alignedOffset, end - alignedOffset, toAdvice(pattern)) != 0)
+    {
+        throw std::runtime_error("Failed to set the access pattern of file: " + m_fileName);
+    }
+}
+
+#endif
+
+}
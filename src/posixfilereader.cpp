@@ -0,0 +1,307 @@
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "utils/posixfilereader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace utils
+{
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+
+namespace
+{
+
+constexpr uint64_t s_minimumWindowSize = 64 * 1024;
+
+constexpr uint64_t alignDown(uint64_t value, uint64_t alignment) noexcept
+{
+    return value - (value % alignment);
+}
+
+constexpr uint64_t alignUp(uint64_t value, uint64_t alignment) noexcept
+{
+    return alignDown(value + alignment - 1, alignment);
+}
+
+int openFile(const std::string& filename, IoMode mode)
+{
+    int flags = O_RDONLY | O_CLOEXEC;
+#ifdef O_DIRECT
+    if (mode == IoMode::Direct)
+    {
+        flags |= O_DIRECT;
+    }
+#endif
+
+    int fd = ::open(filename.c_str(), flags);
+
+#ifdef O_DIRECT
+    if (fd < 0 && errno == EINVAL && mode == IoMode::Direct)
+    {
+        // the file system does not support direct io
+        fd = ::open(filename.c_str(), flags & ~O_DIRECT);
+    }
+#elif defined(F_NOCACHE)
+    if (fd >= 0 && mode == IoMode::Direct)
+    {
+        fcntl(fd, F_NOCACHE, 1);
+    }
+#endif
+
+    return fd;
+}
+
+}
+
+PosixFileReader::PosixFileReader(IoMode mode)
+: m_mode(mode)
+, m_requestedMode(mode)
+, m_fd(-1)
+, m_size(0)
+, m_position(0)
+, m_windowCapacity(0)
+, m_windowPosition(0)
+, m_windowSize(0)
+{
+}
+
+PosixFileReader::~PosixFileReader()
+{
+    close();
+}
+
+void PosixFileReader::open(const std::string& filename)
+{
+    close();
+
+    m_fd = openFile(filename, m_requestedMode);
+    if (m_fd < 0)
+    {
+        throw std::logic_error("Failed to open file for reading: " + filename);
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0)
+    {
+        close();
+        throw std::logic_error("Failed to obtain file size: " + filename);
+    }
+
+    m_mode = m_requestedMode;
+#ifdef O_DIRECT
+    if (m_mode == IoMode::Direct && (fcntl(m_fd, F_GETFL) & O_DIRECT) == 0)
+    {
+        m_mode = IoMode::Cached;
+    }
+#endif
+
+    m_fileName = filename;
+    m_size = static_cast<uint64_t>(st.st_size);
+    m_position = 0;
+    m_windowSize = 0;
+}
+
+void PosixFileReader::close()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+
+    m_fd = -1;
+    m_size = 0;
+    m_position = 0;
+    m_windowSize = 0;
+}
+
+uint64_t PosixFileReader::getContentLength()
+{
+    return m_size;
+}
+
+uint64_t PosixFileReader::currentPosition()
+{
+    return m_position;
+}
+
+bool PosixFileReader::eof()
+{
+    return m_position >= m_size;
+}
+
+std::string PosixFileReader::uri()
+{
+    return m_fileName;
+}
+
+void PosixFileReader::seekAbsolute(uint64_t position)
+{
+    m_position = position;
+}
+
+void PosixFileReader::seekRelative(uint64_t offset)
+{
+    m_position += offset;
+}
+
+uint64_t PosixFileReader::read(uint8_t* pData, uint64_t size)
+{
+    if (m_mode == IoMode::Cached)
+    {
+        auto bytes = readAt(m_position, pData, size);
+        m_position += bytes;
+        return bytes;
+    }
+
+    uint64_t bytes = 0;
+    while (bytes < size)
+    {
+        auto* pDest    = pData + bytes;
+        auto remaining = size - bytes;
+
+        if (m_position % DirectIoAlignment == 0 && reinterpret_cast<uintptr_t>(pDest) % DirectIoAlignment == 0 && remaining >= DirectIoAlignment)
+        {
+            // the aligned part is read directly in the caller buffer
+            auto alignedSize = alignDown(remaining, DirectIoAlignment);
+            auto result      = readAt(m_position, pDest, alignedSize);
+            m_position += result;
+            bytes += result;
+
+            if (result < alignedSize)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        // the rest goes through the window, at most a window at a time so large
+        // reads do not allocate a window of the requested size
+        auto span = peek(std::min(remaining, s_minimumWindowSize));
+        if (span.empty())
+        {
+            break;
+        }
+
+        memcpy(pDest, span.data, span.size);
+        m_position += span.size;
+        bytes += span.size;
+    }
+
+    return bytes;
+}
+
+std::vector<uint8_t> PosixFileReader::readAllData()
+{
+    std::vector<uint8_t> data(m_size);
+
+    seekAbsolute(0);
+    if (data.size() != read(data.data(), data.size()))
+    {
+        throw std::runtime_error("Failed to read all file data for file: " + m_fileName);
+    }
+
+    return data;
+}
+
+void PosixFileReader::clearErrors()
+{
+}
+
+ByteSpan PosixFileReader::peek(uint64_t size)
+{
+    auto windowEnd = m_windowPosition + m_windowSize;
+
+    // a window that reaches the end of the file also covers requests that extend past it
+    bool covered = m_position >= m_windowPosition && m_position <= windowEnd && (m_position + size <= windowEnd || windowEnd >= m_size);
+    if (!covered)
+    {
+        auto start = m_mode == IoMode::Direct ? alignDown(m_position, DirectIoAlignment) : m_position;
+        auto capacity = std::max(alignUp(m_position - start + size, DirectIoAlignment), s_minimumWindowSize);
+
+        if (capacity > m_windowCapacity)
+        {
+            void* ptr = nullptr;
+            if (posix_memalign(&ptr, DirectIoAlignment, capacity) != 0)
+            {
+                throw std::bad_alloc();
+            }
+
+            m_window.reset(static_cast<uint8_t*>(ptr));
+            m_windowCapacity = capacity;
+        }
+
+        m_windowPosition = start;
+        m_windowSize = 0;
+        m_windowSize = readAt(start, m_window.get(), m_windowCapacity);
+    }
+
+    auto offset = m_position - m_windowPosition;
+    if (offset >= m_windowSize)
+    {
+        return ByteSpan();
+    }
+
+    return ByteSpan{m_window.get() + offset, std::min(size, m_windowSize - offset)};
+}
+
+uint64_t PosixFileReader::readAt(uint64_t offset, uint8_t* pData, uint64_t size) const
+{
+    uint64_t bytes = 0;
+    while (bytes < size)
+    {
+        auto result = pread(m_fd, pData + bytes, size - bytes, static_cast<off_t>(offset + bytes));
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw std::runtime_error("Failed to read from file: " + m_fileName + " (" + strerror(errno) + ")");
+        }
+
+        bytes += static_cast<uint64_t>(result);
+
+        // a direct read only ends before the requested size at the end of the file
+        if (result == 0 || (m_mode == IoMode::Direct && static_cast<uint64_t>(result) % DirectIoAlignment != 0))
+        {
+            break;
+        }
+    }
+
+    return bytes;
+}
+
+IoMode PosixFileReader::mode() const noexcept
+{
+    return m_mode;
+}
+
+#endif
+
+}
@@ -20,11 +20,19 @@
 
 #include "utils/filereader.h"
 #include "utils/bufferedreader.h"
+#include "utils/mmapreader.h"
+#include "utils/posixfilereader.h"
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+#include <sys/stat.h>
+#endif
 
 namespace utils
 {
 
 std::vector<std::unique_ptr<IReaderBuilder>> ReaderFactory::m_builders;
+uint64_t ReaderFactory::m_mmapThreshold = UINT64_MAX;
+bool ReaderFactory::m_positionalReads = false;
 
 void ReaderFactory::registerBuilder(std::unique_ptr<IReaderBuilder> builder)
 {
@@ -42,12 +50,35 @@ IReader* ReaderFactory::create(const std::string& uri)
     }
 
     // by default just try to read it from the filesystem
+#if !defined(WIN32) && !defined(__MINGW32__)
+    struct stat st;
+    if (stat(uri.c_str(), &st) == 0 && S_ISREG(st.st_mode) && static_cast<uint64_t>(st.st_size) >= m_mmapThreshold)
+    {
+        return new MmapReader();
+    }
+
+    if (m_positionalReads)
+    {
+        return new PosixFileReader();
+    }
+#endif
+
     return new FileReader();
 }
 
-IReader* ReaderFactory::createBuffered(const std::string& filepath, uint32_t bufferSize)
+void ReaderFactory::setMmapThreshold(uint64_t size)
+{
+    m_mmapThreshold = size;
+}
+
+void ReaderFactory::setPositionalReads(bool enabled)
+{
+    m_positionalReads = enabled;
+}
+
+IReader* ReaderFactory::createBuffered(const std::string& filepath, uint32_t bufferSize, uint32_t readAheadBuffers)
 {
-    return new BufferedReader(std::unique_ptr<utils::IReader>(create(filepath)), bufferSize);
+    return new BufferedReader(std::unique_ptr<utils::IReader>(create(filepath)), bufferSize, readAheadBuffers);
 }
 
 }
@@ -0,0 +1,1100 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "simd.h"
+
+#include <atomic>
+#include <cstring>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define UTILS_SIMD_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace utils
+{
+namespace simd
+{
+
+namespace
+{
+
+uint64_t equalMaskScalar(const char* data, char c) noexcept
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < BlockSize; ++i)
+    {
+        mask |= uint64_t(data[i] == c) << i;
+    }
+
+    return mask;
+}
+
+uint64_t equalAnyMaskScalar(const char* data, char c0, char c1, char c2, char c3) noexcept
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < BlockSize; ++i)
+    {
+        auto c = data[i];
+        mask |= uint64_t(c == c0 || c == c1 || c == c2 || c == c3) << i;
+    }
+
+    return mask;
+}
+
+size_t countScalar(const char* data, size_t size, char c) noexcept
+{
+    size_t result = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        result += data[i] == c;
+    }
+
+    return result;
+}
+
+constexpr size_t NotFound = SIZE_MAX;
+
+size_t findScalar(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    auto pos = std::string_view(data, size).find(std::string_view(needle, needleSize));
+    return pos == std::string_view::npos ? NotFound : pos;
+}
+
+constexpr char toLowerAscii(char c) noexcept
+{
+    return (c >= 'A' && c <= 'Z') ? char(c | 0x20) : c;
+}
+
+constexpr char toUpperAscii(char c) noexcept
+{
+    return (c >= 'a' && c <= 'z') ? char(c & ~0x20) : c;
+}
+
+void toLowerScalar(const char* src, char* dst, size_t size) noexcept
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        dst[i] = toLowerAscii(src[i]);
+    }
+}
+
+void toUpperScalar(const char* src, char* dst, size_t size) noexcept
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        dst[i] = toUpperAscii(src[i]);
+    }
+}
+
+bool equalsIgnoreCaseScalar(const char* lhs, const char* rhs, size_t size) noexcept
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (toLowerAscii(lhs[i]) != toLowerAscii(rhs[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t findIgnoreCaseScalar(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    if (needleSize > size)
+    {
+        return NotFound;
+    }
+
+    const auto first = toLowerAscii(needle[0]);
+    for (size_t i = 0; i + needleSize <= size; ++i)
+    {
+        if (toLowerAscii(data[i]) == first && equalsIgnoreCaseScalar(data + i + 1, needle + 1, needleSize - 1))
+        {
+            return i;
+        }
+    }
+
+    return NotFound;
+}
+
+bool inSet(char c, const char* set, size_t setSize) noexcept
+{
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        if (set[i] == c)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t findFirstNotOfScalar(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (!inSet(data[i], set, setSize))
+        {
+            return i;
+        }
+    }
+
+    return NotFound;
+}
+
+size_t findLastNotOfScalar(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    for (size_t i = size; i > 0; --i)
+    {
+        if (!inSet(data[i - 1], set, setSize))
+        {
+            return i - 1;
+        }
+    }
+
+    return NotFound;
+}
+
+size_t asciiPrefixLengthScalar(const char* data, size_t size) noexcept
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t block;
+        std::memcpy(&block, data + i, sizeof(block));
+        if ((block & 0x8080808080808080) != 0)
+        {
+            break;
+        }
+    }
+
+    while (i < size && static_cast<unsigned char>(data[i]) < 0x80)
+    {
+        ++i;
+    }
+
+    return i;
+}
+
+size_t countContinuationBytesScalar(const char* data, size_t size) noexcept
+{
+    size_t result = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        result += (static_cast<unsigned char>(data[i]) & 0xC0) == 0x80;
+    }
+
+    return result;
+}
+
+constexpr bool isContinuationByte(unsigned char c) noexcept
+{
+    return (c & 0xC0) == 0x80;
+}
+
+// Length of the valid multi-byte sequence at the start of data, 0 when it is invalid
+// Rejects overlong encodings, surrogates, code points above U+10FFFF and truncated sequences
+size_t utf8SequenceLength(const unsigned char* data, size_t size) noexcept
+{
+    const auto lead = data[0];
+    if (lead < 0xC2)
+    {
+        // continuation byte or overlong 2 byte sequence
+        return 0;
+    }
+
+    if (lead < 0xE0)
+    {
+        return (size >= 2 && isContinuationByte(data[1])) ? 2 : 0;
+    }
+
+    if (lead < 0xF0)
+    {
+        if (size < 3 || !isContinuationByte(data[1]) || !isContinuationByte(data[2]) ||
+            (lead == 0xE0 && data[1] < 0xA0) || // overlong
+            (lead == 0xED && data[1] >= 0xA0))  // surrogate
+        {
+            return 0;
+        }
+
+        return 3;
+    }
+
+    if (lead < 0xF5)
+    {
+        if (size < 4 || !isContinuationByte(data[1]) || !isContinuationByte(data[2]) || !isContinuationByte(data[3]) ||
+            (lead == 0xF0 && data[1] < 0x90) || // overlong
+            (lead == 0xF4 && data[1] >= 0x90))  // above U+10FFFF
+        {
+            return 0;
+        }
+
+        return 4;
+    }
+
+    return 0;
+}
+
+// Skips the ASCII runs with the vectorized prefix length, the multi-byte sequences are checked one by one
+template <size_t (*AsciiPrefixLength)(const char*, size_t) noexcept>
+bool validateUtf8Sequential(const char* data, size_t size) noexcept
+{
+    auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    size_t i = 0;
+    while (i < size)
+    {
+        if (bytes[i] < 0x80)
+        {
+            i += AsciiPrefixLength(data + i, size - i);
+            continue;
+        }
+
+        auto length = utf8SequenceLength(bytes + i, size - i);
+        if (length == 0)
+        {
+            return false;
+        }
+
+        i += length;
+    }
+
+    return true;
+}
+
+#ifdef UTILS_SIMD_X86
+// Bit i of the result is set when block[i] is not in the set
+__attribute__((target("sse2"))) inline uint32_t notInSetMaskSse2(__m128i block, const __m128i* set, size_t setSize) noexcept
+{
+    auto matches = _mm_setzero_si128();
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, set[i]));
+    }
+
+    return ~uint32_t(_mm_movemask_epi8(matches)) & 0xFFFF;
+}
+
+__attribute__((target("avx2"))) inline uint32_t notInSetMaskAvx2(__m256i block, const __m256i* set, size_t setSize) noexcept
+{
+    auto matches = _mm256_setzero_si256();
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, set[i]));
+    }
+
+    return ~uint32_t(_mm256_movemask_epi8(matches));
+}
+
+__attribute__((target("sse2"))) size_t findFirstNotOfSse2(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    __m128i setVectors[MaxSetSize];
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        setVectors[i] = _mm_set1_epi8(set[i]);
+    }
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto mask = notInSetMaskSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), setVectors, setSize);
+        if (mask != 0)
+        {
+            return i + countTrailingZeros(mask);
+        }
+    }
+
+    auto pos = findFirstNotOfScalar(data + i, size - i, set, setSize);
+    return pos == NotFound ? NotFound : i + pos;
+}
+
+__attribute__((target("avx2"))) size_t findFirstNotOfAvx2(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    __m256i setVectors[MaxSetSize];
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        setVectors[i] = _mm256_set1_epi8(set[i]);
+    }
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        auto mask = notInSetMaskAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), setVectors, setSize);
+        if (mask != 0)
+        {
+            return i + countTrailingZeros(mask);
+        }
+    }
+
+    auto pos = findFirstNotOfScalar(data + i, size - i, set, setSize);
+    return pos == NotFound ? NotFound : i + pos;
+}
+
+__attribute__((target("sse2"))) size_t findLastNotOfSse2(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    __m128i setVectors[MaxSetSize];
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        setVectors[i] = _mm_set1_epi8(set[i]);
+    }
+
+    size_t end = size;
+    for (; end >= 16; end -= 16)
+    {
+        auto mask = notInSetMaskSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + end - 16)), setVectors, setSize);
+        if (mask != 0)
+        {
+            return end - 16 + (31 - __builtin_clz(mask));
+        }
+    }
+
+    return findLastNotOfScalar(data, end, set, setSize);
+}
+
+__attribute__((target("avx2"))) size_t findLastNotOfAvx2(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    __m256i setVectors[MaxSetSize];
+    for (size_t i = 0; i < setSize; ++i)
+    {
+        setVectors[i] = _mm256_set1_epi8(set[i]);
+    }
+
+    size_t end = size;
+    for (; end >= 32; end -= 32)
+    {
+        auto mask = notInSetMaskAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + end - 32)), setVectors, setSize);
+        if (mask != 0)
+        {
+            return end - 32 + (31 - __builtin_clz(mask));
+        }
+    }
+
+    return findLastNotOfScalar(data, end, set, setSize);
+}
+
+// Flips the case bit of the bytes in the range [rangeBegin, rangeBegin + 26)
+// Adding (128 - rangeBegin) maps the range to the lowest signed values so one
+// signed comparison selects it
+__attribute__((target("sse2"))) inline __m128i flipCaseSse2(__m128i block, char rangeBegin) noexcept
+{
+    auto shifted = _mm_add_epi8(block, _mm_set1_epi8(char(128 - rangeBegin)));
+    auto inRange = _mm_cmplt_epi8(shifted, _mm_set1_epi8(char(-128 + 26)));
+    return _mm_xor_si128(block, _mm_and_si128(inRange, _mm_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2"))) inline __m256i flipCaseAvx2(__m256i block, char rangeBegin) noexcept
+{
+    auto shifted = _mm256_add_epi8(block, _mm256_set1_epi8(char(128 - rangeBegin)));
+    auto inRange = _mm256_cmpgt_epi8(_mm256_set1_epi8(char(-128 + 26)), shifted);
+    return _mm256_xor_si256(block, _mm256_and_si256(inRange, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("sse2"))) void convertCaseSse2(const char* src, char* dst, size_t size, char rangeBegin) noexcept
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), flipCaseSse2(block, rangeBegin));
+    }
+
+    rangeBegin == 'A' ? toLowerScalar(src + i, dst + i, size - i) : toUpperScalar(src + i, dst + i, size - i);
+}
+
+__attribute__((target("avx2"))) void convertCaseAvx2(const char* src, char* dst, size_t size, char rangeBegin) noexcept
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), flipCaseAvx2(block, rangeBegin));
+    }
+
+    rangeBegin == 'A' ? toLowerScalar(src + i, dst + i, size - i) : toUpperScalar(src + i, dst + i, size - i);
+}
+
+__attribute__((target("sse2"))) bool equalsIgnoreCaseSse2(const char* lhs, const char* rhs, size_t size) noexcept
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto lhsBlock = flipCaseSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)), 'A');
+        auto rhsBlock = flipCaseSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)), 'A');
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(lhsBlock, rhsBlock)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+
+    return equalsIgnoreCaseScalar(lhs + i, rhs + i, size - i);
+}
+
+__attribute__((target("avx2"))) bool equalsIgnoreCaseAvx2(const char* lhs, const char* rhs, size_t size) noexcept
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        auto lhsBlock = flipCaseAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)), 'A');
+        auto rhsBlock = flipCaseAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)), 'A');
+        if (uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhsBlock, rhsBlock))) != 0xFFFFFFFF)
+        {
+            return false;
+        }
+    }
+
+    return equalsIgnoreCaseScalar(lhs + i, rhs + i, size - i);
+}
+
+__attribute__((target("sse2"))) size_t findIgnoreCaseSse2(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    const auto first = _mm_set1_epi8(toLowerAscii(needle[0]));
+    const auto last  = _mm_set1_epi8(toLowerAscii(needle[needleSize - 1]));
+
+    size_t i = 0;
+    for (; i + needleSize - 1 + 16 <= size; i += 16)
+    {
+        auto blockFirst = flipCaseSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), 'A');
+        auto blockLast  = flipCaseSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + needleSize - 1)), 'A');
+
+        auto mask = uint32_t(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask != 0)
+        {
+            auto pos = i + countTrailingZeros(mask);
+            if (needleSize < 3 || equalsIgnoreCaseSse2(data + pos + 1, needle + 1, needleSize - 2))
+            {
+                return pos;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    auto pos = findIgnoreCaseScalar(data + i, size - i, needle, needleSize);
+    return pos == NotFound ? NotFound : i + pos;
+}
+
+__attribute__((target("avx2"))) size_t findIgnoreCaseAvx2(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    const auto first = _mm256_set1_epi8(toLowerAscii(needle[0]));
+    const auto last  = _mm256_set1_epi8(toLowerAscii(needle[needleSize - 1]));
+
+    size_t i = 0;
+    for (; i + needleSize - 1 + 32 <= size; i += 32)
+    {
+        auto blockFirst = flipCaseAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), 'A');
+        auto blockLast  = flipCaseAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + needleSize - 1)), 'A');
+
+        auto mask = uint32_t(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+        while (mask != 0)
+        {
+            auto pos = i + countTrailingZeros(mask);
+            if (needleSize < 3 || equalsIgnoreCaseAvx2(data + pos + 1, needle + 1, needleSize - 2))
+            {
+                return pos;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    auto pos = findIgnoreCaseScalar(data + i, size - i, needle, needleSize);
+    return pos == NotFound ? NotFound : i + pos;
+}
+
+__attribute__((target("sse2"))) uint64_t equalMaskSse2(const char* data, char c) noexcept
+{
+    const auto needle = _mm_set1_epi8(c);
+
+    uint64_t mask = 0;
+    for (int i = 0; i < BlockSize; i += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        mask |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)))) << i;
+    }
+
+    return mask;
+}
+
+__attribute__((target("avx2"))) uint64_t equalMaskAvx2(const char* data, char c) noexcept
+{
+    const auto needle = _mm256_set1_epi8(c);
+
+    auto low  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    auto high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+
+    auto lowMask  = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, needle)));
+    auto highMask = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, needle)));
+    return uint64_t(lowMask) | (uint64_t(highMask) << 32);
+}
+
+__attribute__((target("sse2"))) uint64_t equalAnyMaskSse2(const char* data, char c0, char c1, char c2, char c3) noexcept
+{
+    const auto v0 = _mm_set1_epi8(c0);
+    const auto v1 = _mm_set1_epi8(c1);
+    const auto v2 = _mm_set1_epi8(c2);
+    const auto v3 = _mm_set1_epi8(c3);
+
+    uint64_t mask = 0;
+    for (int i = 0; i < BlockSize; i += 16)
+    {
+        auto block   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        auto matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, v0), _mm_cmpeq_epi8(block, v1)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(block, v2), _mm_cmpeq_epi8(block, v3)));
+        mask |= uint64_t(uint32_t(_mm_movemask_epi8(matches))) << i;
+    }
+
+    return mask;
+}
+
+__attribute__((target("avx2"))) uint64_t equalAnyMaskAvx2(const char* data, char c0, char c1, char c2, char c3) noexcept
+{
+    const auto v0 = _mm256_set1_epi8(c0);
+    const auto v1 = _mm256_set1_epi8(c1);
+    const auto v2 = _mm256_set1_epi8(c2);
+    const auto v3 = _mm256_set1_epi8(c3);
+
+    uint64_t mask = 0;
+    for (int i = 0; i < BlockSize; i += 32)
+    {
+        auto block   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        auto matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, v0), _mm256_cmpeq_epi8(block, v1)),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(block, v2), _mm256_cmpeq_epi8(block, v3)));
+        mask |= uint64_t(uint32_t(_mm256_movemask_epi8(matches))) << i;
+    }
+
+    return mask;
+}
+
+__attribute__((target("sse2"))) size_t countSse2(const char* data, size_t size, char c) noexcept
+{
+    const auto needle = _mm_set1_epi8(c);
+
+    size_t result = 0;
+    size_t i      = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        result += __builtin_popcount(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))));
+    }
+
+    return result + countScalar(data + i, size - i, c);
+}
+
+__attribute__((target("avx2,popcnt"))) size_t countAvx2(const char* data, size_t size, char c) noexcept
+{
+    const auto needle = _mm256_set1_epi8(c);
+
+    size_t result = 0;
+    size_t i      = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        result += __builtin_popcount(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle))));
+    }
+
+    return result + countScalar(data + i, size - i, c);
+}
+
+__attribute__((target("sse2"))) size_t findSse2(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    const auto first = _mm_set1_epi8(needle[0]);
+    const auto last  = _mm_set1_epi8(needle[needleSize - 1]);
+
+    size_t i = 0;
+    for (; i + needleSize - 1 + 16 <= size; i += 16)
+    {
+        auto blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        auto blockLast  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + needleSize - 1));
+
+        auto mask = uint32_t(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask != 0)
+        {
+            auto pos = i + countTrailingZeros(mask);
+            if (std::memcmp(data + pos + 1, needle + 1, needleSize - 2) == 0)
+            {
+                return pos;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    auto pos = findScalar(data + i, size - i, needle, needleSize);
+    return pos == NotFound ? NotFound : i + pos;
+}
+
+__attribute__((target("avx2"))) size_t findAvx2(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    const auto first = _mm256_set1_epi8(needle[0]);
+    const auto last  = _mm256_set1_epi8(needle[needleSize - 1]);
+
+    size_t i = 0;
+    for (; i + needleSize - 1 + 32 <= size; i += 32)
+    {
+        auto blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        auto blockLast  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + needleSize - 1));
+
+        auto mask = uint32_t(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+        while (mask != 0)
+        {
+            auto pos = i + countTrailingZeros(mask);
+            if (std::memcmp(data + pos + 1, needle + 1, needleSize - 2) == 0)
+            {
+                return pos;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    auto pos = findScalar(data + i, size - i, needle, needleSize);
+    return pos == NotFound ? NotFound : i + pos;
+}
+
+__attribute__((target("sse2"))) size_t asciiPrefixLengthSse2(const char* data, size_t size) noexcept
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto mask = uint32_t(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))));
+        if (mask != 0)
+        {
+            return i + countTrailingZeros(mask);
+        }
+    }
+
+    return i + asciiPrefixLengthScalar(data + i, size - i);
+}
+
+__attribute__((target("avx2"))) size_t asciiPrefixLengthAvx2(const char* data, size_t size) noexcept
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        auto mask = uint32_t(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))));
+        if (mask != 0)
+        {
+            return i + countTrailingZeros(mask);
+        }
+    }
+
+    return i + asciiPrefixLengthScalar(data + i, size - i);
+}
+
+__attribute__((target("sse2"))) size_t countContinuationBytesSse2(const char* data, size_t size) noexcept
+{
+    // as signed values the continuation bytes (0x80 - 0xBF) are the only ones below 0xC0
+    const auto limit = _mm_set1_epi8(char(0xC0));
+
+    size_t result = 0;
+    size_t i      = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        result += __builtin_popcount(uint32_t(_mm_movemask_epi8(_mm_cmplt_epi8(block, limit))));
+    }
+
+    return result + countContinuationBytesScalar(data + i, size - i);
+}
+
+__attribute__((target("avx2,popcnt"))) size_t countContinuationBytesAvx2(const char* data, size_t size) noexcept
+{
+    const auto limit = _mm256_set1_epi8(char(0xC0));
+
+    size_t result = 0;
+    size_t i      = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        result += __builtin_popcount(uint32_t(_mm256_movemask_epi8(_mm256_cmpgt_epi8(limit, block))));
+    }
+
+    return result + countContinuationBytesScalar(data + i, size - i);
+}
+
+// UTF-8 validation with the lookup algorithm of Keiser and Lemire ("Validating UTF-8 in less than one
+// instruction per byte"). Every error can be detected from the previous byte and the high nibble of the
+// current byte: each of the three nibbles selects the set of errors that are possible for it, an error
+// that is in all three sets is real.
+namespace utf8
+{
+
+constexpr uint8_t TooShort     = 1 << 0; // lead byte or ASCII followed by a lead byte or ASCII
+constexpr uint8_t TooLong      = 1 << 1; // ASCII followed by a continuation byte
+constexpr uint8_t Overlong3    = 1 << 2; // 11100000 100xxxxx
+constexpr uint8_t TooLarge     = 1 << 3; // 11110100 1001xxxx, 11110100 101xxxxx, 11110101 and above
+constexpr uint8_t Surrogate    = 1 << 4; // 11101101 101xxxxx
+constexpr uint8_t Overlong2    = 1 << 5; // 1100000x 10xxxxxx
+constexpr uint8_t TooLarge1000 = 1 << 6; // 11110101 1000xxxx and above
+constexpr uint8_t Overlong4    = 1 << 6; // 11110000 1000xxxx
+constexpr uint8_t TwoConts     = 1 << 7; // two continuation bytes, only valid in 3 and 4 byte sequences
+constexpr uint8_t Carry        = TooShort | TooLong | TwoConts;
+
+// indexed by the high nibble of the previous byte
+alignas(16) constexpr uint8_t Byte1High[16] = {
+    TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+    TwoConts, TwoConts, TwoConts, TwoConts,
+    TooShort | Overlong2,
+    TooShort,
+    TooShort | Overlong3 | Surrogate,
+    TooShort | TooLarge | TooLarge1000 | Overlong4,
+};
+
+// indexed by the low nibble of the previous byte
+alignas(16) constexpr uint8_t Byte1Low[16] = {
+    Carry | Overlong3 | Overlong2 | Overlong4,
+    Carry | Overlong2,
+    Carry,
+    Carry,
+    Carry | TooLarge,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000 | Surrogate,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+};
+
+// indexed by the high nibble of the current byte
+alignas(16) constexpr uint8_t Byte2High[16] = {
+    TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+    TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+    TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+    TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+    TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+    TooShort, TooShort, TooShort, TooShort,
+};
+
+// a lead byte in the last three positions of a block that starts a sequence which does not fit
+// in the block leaves a non zero value after the saturating subtraction
+alignas(32) constexpr uint8_t IncompleteLimit[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+}
+
+// The input shifted N bytes to the right, the first N bytes are the last ones of previous
+template <int N>
+__attribute__((target("avx2"))) inline __m256i shiftInAvx2(__m256i input, __m256i previous) noexcept
+{
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+__attribute__((target("avx2"))) inline __m256i lookupAvx2(const uint8_t* table, __m256i nibbles) noexcept
+{
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table))), nibbles);
+}
+
+__attribute__((target("avx2"))) inline __m256i utf8ErrorsAvx2(__m256i input, __m256i previous) noexcept
+{
+    const auto lowNibble = _mm256_set1_epi8(0x0F);
+
+    auto prev1  = shiftInAvx2<1>(input, previous);
+    auto errors = _mm256_and_si256(
+        _mm256_and_si256(lookupAvx2(utf8::Byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), lowNibble)),
+                         lookupAvx2(utf8::Byte1Low, _mm256_and_si256(prev1, lowNibble))),
+        lookupAvx2(utf8::Byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), lowNibble)));
+
+    // two continuation bytes in a row are required for the third and fourth byte of a sequence
+    auto isThirdByte        = _mm256_subs_epu8(shiftInAvx2<2>(input, previous), _mm256_set1_epi8(char(0xE0 - 0x80)));
+    auto isFourthByte       = _mm256_subs_epu8(shiftInAvx2<3>(input, previous), _mm256_set1_epi8(char(0xF0 - 0x80)));
+    auto mustBeContinuation = _mm256_and_si256(_mm256_or_si256(isThirdByte, isFourthByte), _mm256_set1_epi8(char(0x80)));
+
+    return _mm256_xor_si256(mustBeContinuation, errors);
+}
+
+__attribute__((target("avx2"))) bool validateUtf8Avx2(const char* data, size_t size) noexcept
+{
+    const auto incompleteLimit = _mm256_load_si256(reinterpret_cast<const __m256i*>(utf8::IncompleteLimit));
+
+    auto errors             = _mm256_setzero_si256();
+    auto previous           = _mm256_setzero_si256();
+    auto previousIncomplete = _mm256_setzero_si256();
+
+    alignas(32) char tail[32];
+    for (size_t i = 0; i < size; i += 32)
+    {
+        __m256i input;
+        if (i + 32 <= size)
+        {
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        }
+        else
+        {
+            // the zero padding is ASCII so a truncated sequence at the end is still detected
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, data + i, size - i);
+            input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+        }
+
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            // ASCII only, the previous block must not end in the middle of a sequence
+            errors = _mm256_or_si256(errors, previousIncomplete);
+        }
+        else
+        {
+            errors             = _mm256_or_si256(errors, utf8ErrorsAvx2(input, previous));
+            previousIncomplete = _mm256_subs_epu8(input, incompleteLimit);
+        }
+
+        previous = input;
+    }
+
+    errors = _mm256_or_si256(errors, previousIncomplete);
+    return _mm256_testz_si256(errors, errors) != 0;
+}
+#endif
+
+std::atomic<InstructionSet>& currentInstructionSet() noexcept
+{
+    static std::atomic<InstructionSet> set(detectInstructionSet());
+    return set;
+}
+
+}
+
+InstructionSet detectInstructionSet() noexcept
+{
+#ifdef UTILS_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return InstructionSet::Avx2;
+    }
+
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return InstructionSet::Sse2;
+    }
+#endif
+
+    return InstructionSet::Scalar;
+}
+
+InstructionSet instructionSet() noexcept
+{
+    return currentInstructionSet().load(std::memory_order_relaxed);
+}
+
+void setInstructionSet(InstructionSet set) noexcept
+{
+    auto detected = detectInstructionSet();
+    currentInstructionSet().store(set <= detected ? set : detected, std::memory_order_relaxed);
+}
+
+uint64_t equalMask(const char* data, char c) noexcept
+{
+    return equalMaskFunction()(data, c);
+}
+
+EqualMaskFunction equalMaskFunction() noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return equalMaskAvx2;
+    case InstructionSet::Sse2:  return equalMaskSse2;
+#endif
+    default:                    return equalMaskScalar;
+    }
+}
+
+EqualAnyMaskFunction equalAnyMaskFunction() noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return equalAnyMaskAvx2;
+    case InstructionSet::Sse2:  return equalAnyMaskSse2;
+#endif
+    default:                    return equalAnyMaskScalar;
+    }
+}
+
+size_t find(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    if (needleSize == 0)
+    {
+        return 0;
+    }
+
+    if (needleSize > size)
+    {
+        return NotFound;
+    }
+
+    if (needleSize == 1)
+    {
+        // memchr is vectorized by the c library
+        auto* pos = static_cast<const char*>(std::memchr(data, needle[0], size));
+        return pos ? static_cast<size_t>(pos - data) : NotFound;
+    }
+
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return findAvx2(data, size, needle, needleSize);
+    case InstructionSet::Sse2:  return findSse2(data, size, needle, needleSize);
+#endif
+    default:                    return findScalar(data, size, needle, needleSize);
+    }
+}
+
+void toLower(const char* src, char* dst, size_t size) noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return convertCaseAvx2(src, dst, size, 'A');
+    case InstructionSet::Sse2:  return convertCaseSse2(src, dst, size, 'A');
+#endif
+    default:                    return toLowerScalar(src, dst, size);
+    }
+}
+
+void toUpper(const char* src, char* dst, size_t size) noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return convertCaseAvx2(src, dst, size, 'a');
+    case InstructionSet::Sse2:  return convertCaseSse2(src, dst, size, 'a');
+#endif
+    default:                    return toUpperScalar(src, dst, size);
+    }
+}
+
+bool equalsIgnoreCase(const char* lhs, const char* rhs, size_t size) noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return equalsIgnoreCaseAvx2(lhs, rhs, size);
+    case InstructionSet::Sse2:  return equalsIgnoreCaseSse2(lhs, rhs, size);
+#endif
+    default:                    return equalsIgnoreCaseScalar(lhs, rhs, size);
+    }
+}
+
+size_t findIgnoreCase(const char* data, size_t size, const char* needle, size_t needleSize) noexcept
+{
+    if (needleSize == 0)
+    {
+        return 0;
+    }
+
+    if (needleSize > size)
+    {
+        return NotFound;
+    }
+
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return findIgnoreCaseAvx2(data, size, needle, needleSize);
+    case InstructionSet::Sse2:  return findIgnoreCaseSse2(data, size, needle, needleSize);
+#endif
+    default:                    return findIgnoreCaseScalar(data, size, needle, needleSize);
+    }
+}
+
+size_t findFirstNotOf(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    switch (setSize <= MaxSetSize ? instructionSet() : InstructionSet::Scalar)
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return findFirstNotOfAvx2(data, size, set, setSize);
+    case InstructionSet::Sse2:  return findFirstNotOfSse2(data, size, set, setSize);
+#endif
+    default:                    return findFirstNotOfScalar(data, size, set, setSize);
+    }
+}
+
+size_t findLastNotOf(const char* data, size_t size, const char* set, size_t setSize) noexcept
+{
+    switch (setSize <= MaxSetSize ? instructionSet() : InstructionSet::Scalar)
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return findLastNotOfAvx2(data, size, set, setSize);
+    case InstructionSet::Sse2:  return findLastNotOfSse2(data, size, set, setSize);
+#endif
+    default:                    return findLastNotOfScalar(data, size, set, setSize);
+    }
+}
+
+size_t count(const char* data, size_t size, char c) noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return countAvx2(data, size, c);
+    case InstructionSet::Sse2:  return countSse2(data, size, c);
+#endif
+    default:                    return countScalar(data, size, c);
+    }
+}
+
+
+size_t asciiPrefixLength(const char* data, size_t size) noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return asciiPrefixLengthAvx2(data, size);
+    case InstructionSet::Sse2:  return asciiPrefixLengthSse2(data, size);
+#endif
+    default:                    return asciiPrefixLengthScalar(data, size);
+    }
+}
+
+size_t countContinuationBytes(const char* data, size_t size) noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return countContinuationBytesAvx2(data, size);
+    case InstructionSet::Sse2:  return countContinuationBytesSse2(data, size);
+#endif
+    default:                    return countContinuationBytesScalar(data, size);
+    }
+}
+
+bool validateUtf8(const char* data, size_t size) noexcept
+{
+    switch (instructionSet())
+    {
+#ifdef UTILS_SIMD_X86
+    case InstructionSet::Avx2:  return validateUtf8Avx2(data, size);
+    case InstructionSet::Sse2:  return validateUtf8Sequential<asciiPrefixLengthSse2>(data, size);
+#endif
+    default:                    return validateUtf8Sequential<asciiPrefixLengthScalar>(data, size);
+    }
+}
+
+}
+}
@@ -0,0 +1,132 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized building blocks for the string operations
+// The implementation is selected at runtime based on the capabilities of the cpu,
+// there is always a scalar fallback.
+namespace utils
+{
+namespace simd
+{
+
+enum class InstructionSet
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// Best instruction set supported by the cpu
+InstructionSet detectInstructionSet() noexcept;
+
+// The instruction set that is currently used
+InstructionSet instructionSet() noexcept;
+
+// Force the use of an instruction set, e.g. to test the fallbacks
+// Falls back to the detected instruction set when it is not supported by the cpu
+void setInstructionSet(InstructionSet set) noexcept;
+
+// Number of bytes processed by the functions that return a bit mask
+constexpr int BlockSize = 64;
+
+// Bit i of the result is set when data[i] == c
+// data must point to at least BlockSize readable bytes
+uint64_t equalMask(const char* data, char c) noexcept;
+
+// The equalMask implementation for the current instruction set, avoids the dispatch in tight loops
+using EqualMaskFunction = uint64_t (*)(const char* data, char c) noexcept;
+EqualMaskFunction equalMaskFunction() noexcept;
+
+// Bit i of the result is set when data[i] is one of the four characters, pass a character
+// more than once to search for less characters
+// data must point to at least BlockSize readable bytes
+using EqualAnyMaskFunction = uint64_t (*)(const char* data, char c0, char c1, char c2, char c3) noexcept;
+EqualAnyMaskFunction equalAnyMaskFunction() noexcept;
+
+// Number of occurrences of c in [data, data + size)
+size_t count(const char* data, size_t size, char c) noexcept;
+
+// Offset of the first occurrence of needle in [data, data + size), SIZE_MAX if there is none
+// Candidates are located by comparing the first and last byte of the needle for a block
+// of positions at once, only those are verified with memcmp.
+size_t find(const char* data, size_t size, const char* needle, size_t needleSize) noexcept;
+
+// ASCII case conversion of [src, src + size) into dst, src and dst may be the same buffer
+// Only 'A'-'Z' and 'a'-'z' are changed so multi-byte UTF-8 sequences are left intact
+void toLower(const char* src, char* dst, size_t size) noexcept;
+void toUpper(const char* src, char* dst, size_t size) noexcept;
+
+// ASCII case insensitive comparison of [lhs, lhs + size) and [rhs, rhs + size)
+bool equalsIgnoreCase(const char* lhs, const char* rhs, size_t size) noexcept;
+
+// ASCII case insensitive variant of find
+size_t findIgnoreCase(const char* data, size_t size, const char* needle, size_t needleSize) noexcept;
+
+// Maximum number of characters in the set of findFirstNotOf/findLastNotOf
+constexpr size_t MaxSetSize = 16;
+
+// Offset of the first/last byte in [data, data + size) that is not one of the setSize characters in set,
+// SIZE_MAX if all the bytes are in the set
+size_t findFirstNotOf(const char* data, size_t size, const char* set, size_t setSize) noexcept;
+size_t findLastNotOf(const char* data, size_t size, const char* set, size_t setSize) noexcept;
+
+// Length of the leading ASCII run of [data, data + size)
+size_t asciiPrefixLength(const char* data, size_t size) noexcept;
+
+// Number of UTF-8 continuation bytes (0x80 - 0xBF) in [data, data + size)
+size_t countContinuationBytes(const char* data, size_t size) noexcept;
+
+// True when [data, data + size) is well-formed UTF-8: no overlong encodings, surrogates,
+// code points above U+10FFFF or truncated sequences
+bool validateUtf8(const char* data, size_t size) noexcept;
+
+inline int popCount(uint64_t mask) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(mask);
+#else
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1)
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline int countTrailingZeros(uint64_t mask) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int count = 0;
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+}
+}
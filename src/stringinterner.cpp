@@ -0,0 +1,210 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/stringinterner.h"
+#include "utils/hash.h"
+
+#include <cstring>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <vector>
+
+namespace utils
+{
+
+namespace
+{
+
+constexpr size_t InitialShardCapacity = 64;
+constexpr size_t ArenaBlockSize       = 64 * 1024;
+
+size_t roundUpToPowerOfTwo(size_t value) noexcept
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+unsigned log2(size_t powerOfTwo) noexcept
+{
+    unsigned result = 0;
+    while ((size_t(1) << result) < powerOfTwo)
+    {
+        ++result;
+    }
+
+    return result;
+}
+
+}
+
+// Open addressing hash table with linear probing, the slots point to the entries in the arena
+struct alignas(64) StringInterner::Shard
+{
+    Shard()
+    : slots(InitialShardCapacity, nullptr)
+    , arena(ArenaBlockSize)
+    {
+    }
+
+    // the low shardBits bits of the hash select the shard, skip them for the slot
+    size_t slotIndex(uint64_t hash) const noexcept
+    {
+        return static_cast<size_t>(hash >> shardBits);
+    }
+
+    const InternedString::Entry* find(std::string_view str, uint64_t hash) const noexcept
+    {
+        const size_t mask = slots.size() - 1;
+        for (size_t i = slotIndex(hash) & mask;; i = (i + 1) & mask)
+        {
+            auto* entry = slots[i];
+            if (entry == nullptr)
+            {
+                return nullptr;
+            }
+
+            if (entry->hash == hash && entry->size == str.size() &&
+                std::memcmp(entry + 1, str.data(), str.size()) == 0)
+            {
+                return entry;
+            }
+        }
+    }
+
+    void insert(const InternedString::Entry* entry) noexcept
+    {
+        const size_t mask = slots.size() - 1;
+        auto i            = slotIndex(entry->hash) & mask;
+        while (slots[i] != nullptr)
+        {
+            i = (i + 1) & mask;
+        }
+
+        slots[i] = entry;
+    }
+
+    void grow()
+    {
+        std::vector<const InternedString::Entry*> oldSlots(slots.size() * 2, nullptr);
+        oldSlots.swap(slots);
+
+        for (auto* entry : oldSlots)
+        {
+            if (entry != nullptr)
+            {
+                insert(entry);
+            }
+        }
+    }
+
+    const InternedString::Entry* add(std::string_view str, uint64_t hash)
+    {
+        // keep the load factor below 0.5 so the probe sequences stay short
+        if ((count + 1) * 2 > slots.size())
+        {
+            grow();
+        }
+
+        auto* memory = static_cast<char*>(arena.allocate(sizeof(InternedString::Entry) + str.size() + 1, alignof(InternedString::Entry)));
+        auto* entry  = new (memory) InternedString::Entry{hash, str.size()};
+        std::memcpy(memory + sizeof(InternedString::Entry), str.data(), str.size());
+        memory[sizeof(InternedString::Entry) + str.size()] = '\0';
+
+        insert(entry);
+        ++count;
+        return entry;
+    }
+
+    mutable std::shared_mutex mutex;
+    std::vector<const InternedString::Entry*> slots;
+    size_t count       = 0;
+    unsigned shardBits = 0;
+    std::pmr::monotonic_buffer_resource arena;
+};
+
+StringInterner::StringInterner(size_t shardCount)
+: m_shardMask(roundUpToPowerOfTwo(shardCount == 0 ? 1 : shardCount) - 1)
+, m_shards(std::make_unique<Shard[]>(m_shardMask + 1))
+{
+    const auto shardBits = log2(m_shardMask + 1);
+    for (size_t i = 0; i <= m_shardMask; ++i)
+    {
+        m_shards[i].shardBits = shardBits;
+    }
+}
+
+StringInterner::~StringInterner() noexcept = default;
+
+StringInterner::Shard& StringInterner::shard(uint64_t hash) const noexcept
+{
+    return m_shards[hash & m_shardMask];
+}
+
+InternedString StringInterner::intern(std::string_view str)
+{
+    auto hash   = utils::hash::hash64(str);
+    auto& shard = this->shard(hash);
+
+    {
+        // fast path: the string is already interned
+        std::shared_lock lock(shard.mutex);
+        if (auto* entry = shard.find(str, hash))
+        {
+            return InternedString(entry);
+        }
+    }
+
+    std::unique_lock lock(shard.mutex);
+
+    // another thread could have added it in the meantime
+    if (auto* entry = shard.find(str, hash))
+    {
+        return InternedString(entry);
+    }
+
+    return InternedString(shard.add(str, hash));
+}
+
+InternedString StringInterner::find(std::string_view str) const
+{
+    auto hash   = utils::hash::hash64(str);
+    auto& shard = this->shard(hash);
+
+    std::shared_lock lock(shard.mutex);
+    return InternedString(shard.find(str, hash));
+}
+
+size_t StringInterner::size() const
+{
+    size_t result = 0;
+    for (size_t i = 0; i <= m_shardMask; ++i)
+    {
+        std::shared_lock lock(m_shards[i].mutex);
+        result += m_shards[i].count;
+    }
+
+    return result;
+}
+
+}
@@ -15,245 +15,646 @@
 //    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "utils/stringoperations.h"
+#include "simd.h"
 
 namespace utils
 {
 namespace str
 {
 
+size_t detail::find(std::string_view str, std::string_view search, size_t pos) noexcept
+{
+    if (pos > str.size())
+    {
+        return std::string_view::npos;
+    }
+
+    auto offset = simd::find(str.data() + pos, str.size() - pos, search.data(), search.size());
+    return offset == SIZE_MAX ? std::string_view::npos : pos + offset;
+}
+
+void replace(std::string& aString, std::string_view toSearch, std::string_view toReplace)
+{
+    if (toSearch.empty())
+    {
+        return;
+    }
+
+    if (toReplace.size() <= toSearch.size())
+    {
+        // the output never overtakes the input so the matches can be compacted in place
+        auto* data      = aString.data();
+        size_t readPos  = 0;
+        size_t writePos = 0;
+        size_t foundPos;
+
+        while ((foundPos = find(aString, toSearch, readPos)) != std::string::npos)
+        {
+            if (writePos != readPos)
+            {
+                std::memmove(data + writePos, data + readPos, foundPos - readPos);
+            }
+
+            writePos += foundPos - readPos;
+            std::memcpy(data + writePos, toReplace.data(), toReplace.size());
+            writePos += toReplace.size();
+            readPos = foundPos + toSearch.size();
+        }
+
+        if (readPos == 0)
+        {
+            return;
+        }
+
+        std::memmove(data + writePos, data + readPos, aString.size() - readPos);
+        aString.resize(writePos + aString.size() - readPos);
+        return;
+    }
+
+    size_t matches = 0;
+    for (size_t pos = 0; (pos = find(aString, toSearch, pos)) != std::string::npos; pos += toSearch.size())
+    {
+        ++matches;
+    }
+
+    if (matches == 0)
+    {
+        return;
+    }
+
+    std::string result;
+    result.reserve(aString.size() + matches * (toReplace.size() - toSearch.size()));
+
+    size_t readPos = 0;
+    size_t foundPos;
+    while ((foundPos = find(aString, toSearch, readPos)) != std::string::npos)
+    {
+        result.append(aString, readPos, foundPos - readPos);
+        result.append(toReplace);
+        readPos = foundPos + toSearch.size();
+    }
+
+    result.append(aString, readPos, std::string::npos);
+    aString = std::move(result);
+}
+
+replacer::replacer(std::initializer_list<replacement> replacements)
+{
+    build(replacements.begin(), replacements.size());
+}
+
+replacer::replacer(const std::vector<replacement>& replacements)
+{
+    build(replacements.data(), replacements.size());
+}
+
+void replacer::build(const replacement* replacements, size_t count)
+{
+    m_states.emplace_back();
+    m_states.front().next.fill(0);
+
+    // trie of the patterns, 0 is the root and means no transition while building
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto pattern = replacements[i].first;
+        if (pattern.empty())
+        {
+            continue;
+        }
+
+        int32_t state = 0;
+        for (char c : pattern)
+        {
+            auto& next = m_states[state].next[static_cast<unsigned char>(c)];
+            if (next == 0)
+            {
+                next = static_cast<int32_t>(m_states.size());
+                State newState;
+                newState.next.fill(0);
+                newState.depth = m_states[state].depth + 1;
+                m_states.push_back(newState);
+            }
+
+            state = m_states[state].next[static_cast<unsigned char>(c)];
+        }
+
+        // the first occurrence of a duplicate pattern wins
+        if (m_states[state].pattern == NoPattern)
+        {
+            m_states[state].pattern = static_cast<int32_t>(m_patterns.size());
+            m_patterns.emplace_back(pattern);
+            m_replacements.emplace_back(replacements[i].second);
+        }
+    }
+
+    int32_t firstBytes = 0;
+    for (size_t c = 0; c < 256; ++c)
+    {
+        if (m_states.front().next[c] != 0)
+        {
+            ++firstBytes;
+            m_firstByte = static_cast<int32_t>(c);
+        }
+    }
+
+    if (firstBytes != 1)
+    {
+        m_firstByte = -1;
+    }
+
+    // breadth first: turn the trie into a complete automaton using the failure links
+    std::vector<int32_t> failure(m_states.size(), 0);
+    std::vector<int32_t> queue;
+    queue.reserve(m_states.size());
+
+    for (auto next : m_states.front().next)
+    {
+        if (next != 0)
+        {
+            queue.push_back(next);
+        }
+    }
+
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        auto state = queue[i];
+
+        // a longer pattern ending in this state starts earlier so it takes precedence
+        if (m_states[state].pattern == NoPattern)
+        {
+            m_states[state].pattern = m_states[failure[state]].pattern;
+        }
+
+        for (size_t c = 0; c < 256; ++c)
+        {
+            auto& next = m_states[state].next[c];
+            if (next == 0)
+            {
+                next = m_states[failure[state]].next[c];
+            }
+            else
+            {
+                failure[next] = m_states[failure[state]].next[c];
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+size_t replacer::findMatch(std::string_view str, size_t pos, int32_t& pattern) const noexcept
+{
+    // leftmost-longest: a match is only accepted once no pattern that starts at the same
+    // position or earlier can still be matched, i.e. the current state starts after it
+    size_t matchPos = std::string_view::npos;
+    size_t matchLen = 0;
+    pattern         = NoPattern;
+
+    int32_t state = 0;
+    for (size_t i = pos; i < str.size(); ++i)
+    {
+        if (state == 0 && m_firstByte >= 0)
+        {
+            // all patterns start with the same byte: skip to its next occurrence
+            auto* next = static_cast<const char*>(std::memchr(str.data() + i, m_firstByte, str.size() - i));
+            if (next == nullptr)
+            {
+                break;
+            }
+
+            i = static_cast<size_t>(next - str.data());
+        }
+
+        state               = m_states[state].next[static_cast<unsigned char>(str[i])];
+        const auto& current = m_states[state];
+
+        if (current.pattern != NoPattern)
+        {
+            auto length = m_patterns[current.pattern].size();
+            auto start  = i + 1 - length;
+            if (matchPos == std::string_view::npos || start < matchPos || (start == matchPos && length > matchLen))
+            {
+                matchPos = start;
+                matchLen = length;
+                pattern  = current.pattern;
+            }
+        }
+
+        if (matchPos != std::string_view::npos && i + 1 - current.depth > matchPos)
+        {
+            break;
+        }
+    }
+
+    return matchPos;
+}
+
+void replacer::replace(std::string_view str, std::string& output) const
+{
+    output.reserve(output.size() + str.size());
+
+    size_t pos = 0;
+    int32_t pattern;
+    size_t matchPos;
+    while ((matchPos = findMatch(str, pos, pattern)) != std::string_view::npos)
+    {
+        output.append(str.substr(pos, matchPos - pos));
+        output.append(m_replacements[pattern]);
+        pos = matchPos + m_patterns[pattern].size();
+    }
+
+    output.append(str.substr(pos));
+}
+
+std::string replacer::replace(std::string_view str) const
+{
+    std::string result;
+    replace(str, result);
+    return result;
+}
+
+std::string replace_all(std::string_view str, std::initializer_list<replacer::replacement> replacements)
+{
+    return replacer(replacements).replace(str);
+}
+
 void lowercase_in_place(std::string& aString)
 {
-    std::transform(aString.begin(), aString.end(), aString.begin(), [](char c) { return std::tolower(c); });
+    simd::toLower(aString.data(), aString.data(), aString.size());
 }
 
 std::string lowercase(std::string_view aString)
 {
-    std::string lower(aString.begin(), aString.end());
-    lowercase_in_place(lower);
+    std::string lower(aString.size(), '\0');
+    simd::toLower(aString.data(), lower.data(), aString.size());
     return lower;
 }
 
 void uppercase_in_place(std::string& aString)
 {
-    std::transform(aString.begin(), aString.end(), aString.begin(), [](char c) { return std::toupper(c); });
+    simd::toUpper(aString.data(), aString.data(), aString.size());
 }
 
-std::string uppercase(const std::string& aString)
+std::string uppercase(std::string_view aString)
 {
-    std::string upper(aString.begin(), aString.end());
-    uppercase_in_place(upper);
+    std::string upper(aString.size(), '\0');
+    simd::toUpper(aString.data(), upper.data(), aString.size());
     return upper;
 }
 
-std::string_view trimmed_view(std::string_view str)
+void lowercase_into(std::string_view aString, char* output) noexcept
+{
+    simd::toLower(aString.data(), output, aString.size());
+}
+
+void uppercase_into(std::string_view aString, char* output) noexcept
+{
+    simd::toUpper(aString.data(), output, aString.size());
+}
+
+bool iequals(std::string_view lhs, std::string_view rhs) noexcept
+{
+    return lhs.size() == rhs.size() && simd::equalsIgnoreCase(lhs.data(), rhs.data(), lhs.size());
+}
+
+bool istarts_with(std::string_view aString, std::string_view search) noexcept
+{
+    return search.size() <= aString.size() && simd::equalsIgnoreCase(aString.data(), search.data(), search.size());
+}
+
+size_t ifind(std::string_view str, std::string_view search, size_t pos) noexcept
+{
+    if (pos > str.size())
+    {
+        return std::string_view::npos;
+    }
+
+    auto offset = simd::findIgnoreCase(str.data() + pos, str.size() - pos, search.data(), search.size());
+    return offset == SIZE_MAX ? std::string_view::npos : pos + offset;
+}
+
+namespace
+{
+
+// Number of leading bytes that are checked one by one before switching to the vectorized search
+// Most strings have little or no padding
+constexpr size_t ScalarTrimLength = 16;
+
+inline std::string_view trimmed(std::string_view str, const char_set& chars) noexcept
 {
     if (str.empty())
     {
         return str;
     }
 
-    auto begin = str.find_first_not_of(" \t\r\n");
-    auto end   = str.find_last_not_of(" \t\r\n");
+    size_t begin = 0;
+    size_t end   = str.size();
+
+    while (begin < end && chars.contains(str[begin]))
+    {
+        if (++begin == ScalarTrimLength && !chars.chars().empty())
+        {
+            auto pos = simd::findFirstNotOf(str.data() + begin, end - begin, chars.chars().data(), chars.size());
+            begin    = pos == SIZE_MAX ? end : begin + pos;
+            break;
+        }
+    }
 
-    if (begin == std::string_view::npos && end == std::string_view::npos)
+    if (begin == end)
     {
         return std::string_view();
     }
 
-    assert(begin != std::string_view::npos);
-    assert(end != std::string_view::npos);
-    assert(begin <= end);
+    size_t trailing = 0;
+    while (chars.contains(str[end - 1]))
+    {
+        --end;
+        if (++trailing == ScalarTrimLength && !chars.chars().empty())
+        {
+            // there is at least one character that is not in the set: str[begin]
+            end = begin + simd::findLastNotOf(str.data() + begin, end - begin, chars.chars().data(), chars.size()) + 1;
+            break;
+        }
+    }
+
+    return str.substr(begin, end - begin);
+}
+
+}
+
+std::string_view detail::trimmed_view(std::string_view str, const char_set& chars) noexcept
+{
+    return trimmed(str, chars);
+}
 
-    return std::string_view(&str[begin], (end + 1) - begin);
+void trim_all(std::string_view* tokens, size_t count, const char_set& chars) noexcept
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        tokens[i] = trimmed(tokens[i], chars);
+    }
 }
 
-std::string trim(std::string_view str)
+std::string trim(std::string_view str, const char_set& chars)
 {
-    auto trimmed = trimmed_view(str);
-    return std::string(trimmed.begin(), trimmed.end());
+    auto trimmedStr = trimmed(str, chars);
+    return std::string(trimmedStr.begin(), trimmedStr.end());
 }
 
-void trim_in_place(std::string& str)
+void trim_in_place(std::string& str, const char_set& chars)
 {
-    auto trimmed = trimmed_view(str);
-    if (trimmed.data() == str.data() && trimmed.size() == str.size())
+    auto trimmedStr = trimmed(str, chars);
+    if (trimmedStr.data() == str.data() && trimmedStr.size() == str.size())
     {
         // no trimming was needed
         return;
     }
 
-    str.assign(trimmed.begin(), trimmed.end());
+    str.assign(trimmedStr.begin(), trimmedStr.end());
+}
+
+namespace
+{
+
+constexpr bool isUnreserved(unsigned char c, url_encoding encoding) noexcept
+{
+    if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+    {
+        return true;
+    }
+
+    if (encoding == url_encoding::rfc3986)
+    {
+        return c == '-' || c == '.' || c == '_' || c == '~';
+    }
+
+    return c == '*' || c == '-' || c == '.' || c == '_';
 }
 
-std::string urlEncode(const std::string& aString)
+// Number of output characters for every input byte: 1 if it is copied as is, 3 for a %XX escape
+// The space is encoded as a single '+' in form encoding
+constexpr std::array<uint8_t, 256> createEncodedSizeTable(url_encoding encoding) noexcept
 {
-    std::stringstream result;
+    std::array<uint8_t, 256> table = {};
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        auto c   = static_cast<unsigned char>(i);
+        table[i] = (isUnreserved(c, encoding) || (encoding == url_encoding::form && c == ' ')) ? 1 : 3;
+    }
 
-    for (size_t i = 0; i < aString.size(); ++i)
+    return table;
+}
+
+constexpr std::array<std::array<uint8_t, 256>, 2> s_encodedSize = {
+    createEncodedSizeTable(url_encoding::rfc3986),
+    createEncodedSizeTable(url_encoding::form),
+};
+
+constexpr const char* s_hexDigits = "0123456789ABCDEF";
+
+constexpr std::array<int8_t, 256> createHexValueTable() noexcept
+{
+    std::array<int8_t, 256> table = {};
+    for (size_t i = 0; i < table.size(); ++i)
     {
-        int curChar = static_cast<int>(static_cast<unsigned char>(aString[i]));
-        if ((curChar >= 48 && curChar <= 57) ||
-            (curChar >= 65 && curChar <= 90) ||
-            (curChar >= 97 && curChar <= 122) ||
-            aString[i] == '-' || aString[i] == '_' ||
-            aString[i] == '.' || aString[i] == '!' ||
-            aString[i] == '~' || aString[i] == '*' ||
-            aString[i] == '\'' || aString[i] == '(' ||
-            aString[i] == ')')
+        if (i >= '0' && i <= '9')
+        {
+            table[i] = static_cast<int8_t>(i - '0');
+        }
+        else if (i >= 'A' && i <= 'F')
         {
-            result << aString[i];
+            table[i] = static_cast<int8_t>(i - 'A' + 10);
         }
-        else if (aString[i] == ' ')
+        else if (i >= 'a' && i <= 'f')
         {
-            result << '+';
+            table[i] = static_cast<int8_t>(i - 'a' + 10);
         }
         else
         {
-            result << '%' << std::hex << curChar;
+            table[i] = -1;
         }
     }
 
-    return result.str();
+    return table;
 }
 
-static void applySplitOptions(std::string_view sv, flags<split_opt> opt, std::vector<std::string_view>& tokens)
+constexpr std::array<int8_t, 256> s_hexValue = createHexValueTable();
+
+}
+
+size_t urlEncodedSize(std::string_view str, url_encoding encoding) noexcept
 {
-    if (opt.is_set(split_opt::trim))
-    {
-        sv = trimmed_view(sv);
-    }
+    const auto& table = s_encodedSize[static_cast<size_t>(encoding)];
 
-    if (!opt.is_set(split_opt::no_empty) || !sv.empty())
+    size_t size = 0;
+    for (char c : str)
     {
-        tokens.emplace_back(sv);
+        size += table[static_cast<unsigned char>(c)];
     }
+
+    return size;
 }
 
-std::vector<std::string_view> splitted_view(std::string_view str, char delimiter, flags<split_opt> opt)
+size_t urlEncode(std::string_view str, char* output, url_encoding encoding) noexcept
 {
-    std::vector<std::string_view> tokens;
+    const auto& table = s_encodedSize[static_cast<size_t>(encoding)];
 
-    size_t      length = 0;
-    const char* start  = str.data();
-    for (size_t i = 0; i < str.size(); ++i)
+    char* out = output;
+    for (char c : str)
     {
-        if (str[i] == delimiter)
+        auto byte = static_cast<unsigned char>(c);
+        if (table[byte] == 1)
         {
-            applySplitOptions(std::string_view(start, length), opt, tokens);
-            length = 0;
-
-            if (i + 1 < str.size())
-            {
-                start = &str[i + 1];
-            }
+            *out++ = byte == ' ' ? '+' : c;
         }
         else
         {
-            ++length;
+            out[0] = '%';
+            out[1] = s_hexDigits[byte >> 4];
+            out[2] = s_hexDigits[byte & 0x0F];
+            out += 3;
         }
     }
 
-    if (length > 0)
+    return static_cast<size_t>(out - output);
+}
+
+std::string urlEncode(std::string_view str, url_encoding encoding)
+{
+    std::string result(urlEncodedSize(str, encoding), '\0');
+    urlEncode(str, result.data(), encoding);
+    return result;
+}
+
+size_t urlDecode(std::string_view str, char* output, url_encoding encoding) noexcept
+{
+    char* out = output;
+    for (size_t i = 0; i < str.size(); ++i)
     {
-        applySplitOptions(std::string_view(start, length), opt, tokens);
+        auto c = str[i];
+        if (c == '%' && i + 2 < str.size())
+        {
+            auto high = s_hexValue[static_cast<unsigned char>(str[i + 1])];
+            auto low  = s_hexValue[static_cast<unsigned char>(str[i + 2])];
+            if (high >= 0 && low >= 0)
+            {
+                *out++ = static_cast<char>((high << 4) | low);
+                i += 2;
+                continue;
+            }
+        }
+
+        // malformed escapes are copied as is
+        *out++ = (c == '+' && encoding == url_encoding::form) ? ' ' : c;
     }
 
-    if (*start == delimiter)
+    return static_cast<size_t>(out - output);
+}
+
+std::string urlDecode(std::string_view str, url_encoding encoding)
+{
+    std::string result(str.size(), '\0');
+    result.resize(urlDecode(str, result.data(), encoding));
+    return result;
+}
+
+static inline void applySplitOptions(std::string_view sv, flags<split_opt> opt, std::vector<std::string_view>& tokens)
+{
+    if (opt.is_set(split_opt::trim))
     {
-        applySplitOptions(std::string_view(), opt, tokens);
+        sv = trimmed_view(sv);
     }
 
-    if (tokens.empty())
+    if (!opt.is_set(split_opt::no_empty) || !sv.empty())
     {
-        applySplitOptions(str, opt, tokens);
+        tokens.emplace_back(sv);
     }
-
-    return tokens;
 }
 
-std::vector<std::string_view> splitted_view(std::string_view str, std::string_view delimiter, flags<split_opt> opt)
+std::vector<std::string_view> splitted_view(std::string_view str, char delimiter, flags<split_opt> opt)
 {
     std::vector<std::string_view> tokens;
+    tokens.reserve(simd::count(str.data(), str.size(), delimiter) + 1);
 
-    size_t      length      = 0;
-    size_t      matchLength = 0;
-    const char* start       = str.data();
+    const char* data          = str.data();
+    size_t      start         = 0;
+    size_t      pos           = 0;
+    bool        previousEmpty = false;
 
-    for (size_t i = 0; i < str.size(); ++i)
+    // locate the delimiters a block at a time, a set bit in the mask marks a delimiter
+    const auto equalMask = simd::equalMaskFunction();
+    for (; pos + simd::BlockSize <= str.size(); pos += simd::BlockSize)
     {
-        if (str[i] == delimiter[matchLength])
+        auto mask = equalMask(data + pos, delimiter);
+        while (mask != 0)
         {
-            ++matchLength;
-
-            if (matchLength == delimiter.size())
-            {
-                applySplitOptions(std::string_view(start, length), opt, tokens);
-                length      = 0;
-                matchLength = 0;
-
-                if (i + 1 < str.size())
-                {
-                    start = &str[i + 1];
-                }
-
-                continue;
-            }
-        }
-        else
-        {
-            length += matchLength;
-            ++length;
-            matchLength = 0;
+            auto delimiterPos = pos + simd::countTrailingZeros(mask);
+            applySplitOptions(std::string_view(data + start, delimiterPos - start), opt, tokens);
+            previousEmpty = delimiterPos == start;
+            start         = delimiterPos + 1;
+            mask &= mask - 1;
         }
     }
 
-    if (matchLength == delimiter.size())
-    {
-        applySplitOptions(std::string_view(), opt, tokens);
-    }
-    else if (length + matchLength > 0)
+    for (; pos < str.size(); ++pos)
     {
-        applySplitOptions(std::string_view(start, length), opt, tokens);
+        if (data[pos] == delimiter)
+        {
+            applySplitOptions(std::string_view(data + start, pos - start), opt, tokens);
+            previousEmpty = pos == start;
+            start         = pos + 1;
+        }
     }
 
-    if (length == 0 && matchLength == 0)
+    // a trailing delimiter only ends a token when the token before it was empty
+    if (start < str.size() || previousEmpty)
     {
-        applySplitOptions(std::string_view(), opt, tokens);
+        applySplitOptions(std::string_view(data + start, str.size() - start), opt, tokens);
     }
 
     if (tokens.empty())
     {
-        applySplitOptions(std::string_view(start, length), opt, tokens);
+        applySplitOptions(str, opt, tokens);
     }
 
     return tokens;
 }
 
-std::vector<std::string> split(std::string_view str, char delimiter, flags<split_opt> opt)
+std::vector<std::string_view> splitted_view(std::string_view str, std::string_view delimiter, flags<split_opt> opt)
 {
-    auto splitted = splitted_view(str, delimiter, opt);
-
-    std::vector<std::string> tokens;
-    tokens.reserve(splitted.size());
-    for (auto& v : splitted)
+    std::vector<std::string_view> tokens;
+    for (auto token : split_range(str, string_delimiter(delimiter), opt))
     {
-        tokens.emplace_back(begin(v), end(v));
+        tokens.push_back(token);
     }
 
     return tokens;
 }
 
-std::vector<std::string> split(std::string_view str, const std::string& delimiter, flags<split_opt> opt)
+std::vector<std::string> split(std::string_view str, char delimiter, flags<split_opt> opt)
 {
-    auto splitted = splitted_view(str, delimiter, opt);
+    std::vector<std::string> tokens;
+    split_into(str, delimiter, tokens, opt);
+    return tokens;
+}
 
+std::vector<std::string> split(std::string_view str, const std::string& delimiter, flags<split_opt> opt)
+{
     std::vector<std::string> tokens;
-    tokens.reserve(splitted.size());
-    tokens.reserve(splitted.size());
-    for (auto& v : splitted)
-    {
-        tokens.emplace_back(begin(v), end(v));
-    }
+    split_into(str, string_delimiter(delimiter), tokens, opt);
+    return tokens;
+}
+
+std::pmr::vector<std::pmr::string> split(std::string_view str, char delimiter, std::pmr::memory_resource& arena, flags<split_opt> opt)
+{
+    std::pmr::vector<std::pmr::string> tokens(&arena);
+    split_into(str, delimiter, tokens, opt);
+    return tokens;
+}
+
+std::pmr::vector<std::pmr::string> split(std::string_view str, std::string_view delimiter, std::pmr::memory_resource& arena, flags<split_opt> opt)
+{
+    std::pmr::vector<std::pmr::string> tokens(&arena);
+    split_into(str, string_delimiter(delimiter), tokens, opt);
     return tokens;
 }
 
@@ -0,0 +1,241 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "utils/utf8.h"
+#include "simd.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace utils
+{
+namespace str
+{
+
+namespace
+{
+
+void throwIfInvalid(std::string_view str)
+{
+    if (!simd::validateUtf8(str.data(), str.size()))
+    {
+        throw std::invalid_argument("Invalid UTF-8 string");
+    }
+}
+
+// True when the next 16 bytes are available and all ASCII
+inline bool isAsciiBlock(const unsigned char* data, size_t size) noexcept
+{
+    if (size < 16)
+    {
+        return false;
+    }
+
+    uint64_t first, second;
+    std::memcpy(&first, data, sizeof(first));
+    std::memcpy(&second, data + sizeof(first), sizeof(second));
+    return ((first | second) & 0x8080808080808080) == 0;
+}
+
+// Decodes validated UTF-8 into output, which must hold at least str.size() characters
+// Returns the number of characters that were written
+template <typename CharType>
+size_t decodeUtf8(std::string_view str, CharType* output) noexcept
+{
+    auto* data = reinterpret_cast<const unsigned char*>(str.data());
+    auto size  = str.size();
+    auto* out  = output;
+
+    size_t i = 0;
+    while (i < size)
+    {
+        auto lead = data[i];
+        if (lead < 0x80)
+        {
+            // short ASCII runs between multi-byte characters are not worth the vectorized search
+            if (!isAsciiBlock(data + i, size - i))
+            {
+                *out++ = CharType(lead);
+                ++i;
+                continue;
+            }
+
+            auto asciiLength = simd::asciiPrefixLength(str.data() + i, size - i);
+            for (size_t j = 0; j < asciiLength; ++j)
+            {
+                out[j] = CharType(data[i + j]);
+            }
+
+            out += asciiLength;
+            i += asciiLength;
+            continue;
+        }
+
+        char32_t codePoint;
+        if (lead < 0xE0)
+        {
+            codePoint = (char32_t(lead & 0x1F) << 6) | (data[i + 1] & 0x3F);
+            i += 2;
+        }
+        else if (lead < 0xF0)
+        {
+            codePoint = (char32_t(lead & 0x0F) << 12) | (char32_t(data[i + 1] & 0x3F) << 6) | (data[i + 2] & 0x3F);
+            i += 3;
+        }
+        else
+        {
+            codePoint = (char32_t(lead & 0x07) << 18) | (char32_t(data[i + 1] & 0x3F) << 12) |
+                        (char32_t(data[i + 2] & 0x3F) << 6) | (data[i + 3] & 0x3F);
+            i += 4;
+        }
+
+        if constexpr (sizeof(CharType) == sizeof(char16_t))
+        {
+            if (codePoint >= 0x10000)
+            {
+                // surrogate pair, 4 input bytes become 2 output characters
+                codePoint -= 0x10000;
+                *out++ = char16_t(0xD800 + (codePoint >> 10));
+                *out++ = char16_t(0xDC00 + (codePoint & 0x3FF));
+                continue;
+            }
+        }
+
+        *out++ = CharType(codePoint);
+    }
+
+    return static_cast<size_t>(out - output);
+}
+
+inline char* encodeUtf8(char32_t codePoint, char* out) noexcept
+{
+    if (codePoint < 0x80)
+    {
+        *out++ = char(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        *out++ = char(0xC0 | (codePoint >> 6));
+        *out++ = char(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        *out++ = char(0xE0 | (codePoint >> 12));
+        *out++ = char(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = char(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        *out++ = char(0xF0 | (codePoint >> 18));
+        *out++ = char(0x80 | ((codePoint >> 12) & 0x3F));
+        *out++ = char(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = char(0x80 | (codePoint & 0x3F));
+    }
+
+    return out;
+}
+
+constexpr bool isSurrogate(char32_t c) noexcept
+{
+    return c >= 0xD800 && c <= 0xDFFF;
+}
+
+}
+
+bool is_valid_utf8(std::string_view str) noexcept
+{
+    return simd::validateUtf8(str.data(), str.size());
+}
+
+size_t utf8_length(std::string_view str) noexcept
+{
+    return str.size() - simd::countContinuationBytes(str.data(), str.size());
+}
+
+std::u16string utf8_to_utf16(std::string_view str)
+{
+    throwIfInvalid(str);
+
+    // every UTF-8 byte produces at most one UTF-16 character
+    std::u16string result(str.size(), u'\0');
+    result.resize(decodeUtf8(str, result.data()));
+    return result;
+}
+
+std::u32string utf8_to_utf32(std::string_view str)
+{
+    throwIfInvalid(str);
+
+    std::u32string result(str.size(), U'\0');
+    result.resize(decodeUtf8(str, result.data()));
+    return result;
+}
+
+std::string utf16_to_utf8(std::u16string_view str)
+{
+    // a surrogate pair becomes 4 bytes, all other characters at most 3
+    std::string result(str.size() * 3, '\0');
+    auto* out = result.data();
+
+    const auto size = str.size();
+    for (size_t i = 0; i < size; ++i)
+    {
+        char32_t c = str[i];
+        if (c < 0x80)
+        {
+            *out++ = char(c);
+            continue;
+        }
+
+        if (isSurrogate(c))
+        {
+            if (c >= 0xDC00 || i + 1 == size || str[i + 1] < 0xDC00 || str[i + 1] > 0xDFFF)
+            {
+                throw std::invalid_argument("Invalid UTF-16 string: unpaired surrogate");
+            }
+
+            c = 0x10000 + ((c - 0xD800) << 10) + (str[++i] - 0xDC00);
+        }
+
+        out = encodeUtf8(c, out);
+    }
+
+    result.resize(static_cast<size_t>(out - result.data()));
+    return result;
+}
+
+std::string utf32_to_utf8(std::u32string_view str)
+{
+    std::string result(str.size() * 4, '\0');
+    auto* out = result.data();
+
+    for (auto c : str)
+    {
+        if (c > 0x10FFFF || isSurrogate(c))
+        {
+            throw std::invalid_argument("Invalid UTF-32 string: not a unicode scalar value");
+        }
+
+        out = encodeUtf8(c, out);
+    }
+
+    result.resize(static_cast<size_t>(out - result.data()));
+    return result;
+}
+
+}
+}
@@ -0,0 +1,108 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/boundedqueue.h"
+#include "gtest/gtest.h"
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace utils;
+using namespace testing;
+
+TEST(BoundedQueueTest, CapacityIsRoundedUpToPowerOfTwo)
+{
+    EXPECT_EQ(2u, BoundedQueue<int>(1).capacity());
+    EXPECT_EQ(8u, BoundedQueue<int>(8).capacity());
+    EXPECT_EQ(16u, BoundedQueue<int>(9).capacity());
+}
+
+TEST(BoundedQueueTest, PushPop)
+{
+    BoundedQueue<std::string> queue(4);
+    EXPECT_TRUE(queue.empty());
+
+    EXPECT_TRUE(queue.tryPush("one"));
+    EXPECT_TRUE(queue.tryPush("two"));
+    EXPECT_FALSE(queue.empty());
+
+    std::string value;
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ("one", value);
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ("two", value);
+    EXPECT_FALSE(queue.tryPop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedQueueTest, PushOnFullQueueFails)
+{
+    BoundedQueue<std::string> queue(2);
+    EXPECT_TRUE(queue.tryPush("one"));
+    EXPECT_TRUE(queue.tryPush("two"));
+
+    std::string value("three");
+    EXPECT_FALSE(queue.tryPush(std::move(value)));
+    EXPECT_EQ("three", value);
+
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ("one", value);
+    EXPECT_TRUE(queue.tryPush("three"));
+}
+
+TEST(BoundedQueueTest, MultipleProducers)
+{
+    const int producerCount = 4;
+    const int itemsPerProducer = 1000;
+
+    BoundedQueue<int> queue(64);
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&queue] () {
+            for (int i = 1; i <= itemsPerProducer; ++i)
+            {
+                while (!queue.tryPush(int(i)))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int64_t sum = 0;
+    int count = 0;
+    while (count < producerCount * itemsPerProducer)
+    {
+        int value;
+        if (queue.tryPop(value))
+        {
+            sum += value;
+            ++count;
+        }
+    }
+
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(int64_t(producerCount) * (int64_t(itemsPerProducer) * (itemsPerProducer + 1) / 2), sum);
+    EXPECT_TRUE(queue.empty());
+}
@@ -35,11 +35,12 @@ namespace test
 
 static const std::string g_testFile = "bufferedreadertestfile.bin";
 
-class BufferedReaderTest : public Test
+// the parameter is the number of read ahead buffers
+class BufferedReaderTest : public TestWithParam<uint32_t>
 {
 public:
     BufferedReaderTest()
-    : reader(std::make_unique<FileReader>(), 10)
+    : reader(std::make_unique<FileReader>(), 10, GetParam())
     {
     }
 
@@ -71,12 +72,12 @@ protected:
     std::vector<uint8_t>    data;
 };
 
-TEST_F(BufferedReaderTest, contentLength)
+TEST_P(BufferedReaderTest, contentLength)
 {
     EXPECT_EQ(100U, reader.getContentLength());
 }
 
-TEST_F(BufferedReaderTest, readFullBuffer)
+TEST_P(BufferedReaderTest, readFullBuffer)
 {
     std::vector<uint8_t> readData(data.size(), '\0');
     EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
@@ -85,7 +86,7 @@ TEST_F(BufferedReaderTest, readFullBuffer)
     EXPECT_TRUE(reader.eof());
 }
 
-TEST_F(BufferedReaderTest, readSmallData)
+TEST_P(BufferedReaderTest, readSmallData)
 {
     std::array<uint8_t, 2> readData;
 
@@ -115,14 +116,14 @@ TEST_F(BufferedReaderTest, readSmallData)
     EXPECT_FALSE(reader.eof());
 }
 
-TEST_F(BufferedReaderTest, readAllData)
+TEST_P(BufferedReaderTest, readAllData)
 {
     auto readData = reader.readAllData();
     EXPECT_EQ(data, readData);
     EXPECT_TRUE(reader.eof());
 }
 
-TEST_F(BufferedReaderTest, readOutsideExistingBuffer)
+TEST_P(BufferedReaderTest, readOutsideExistingBuffer)
 {
     std::array<uint8_t, 6> readData;
 
@@ -146,7 +147,7 @@ TEST_F(BufferedReaderTest, readOutsideExistingBuffer)
     EXPECT_FALSE(reader.eof());
 }
 
-TEST_F(BufferedReaderTest, bigReadAfterSmallRead)
+TEST_P(BufferedReaderTest, bigReadAfterSmallRead)
 {
     std::array<uint8_t, 2> readData;
 
@@ -166,7 +167,7 @@ TEST_F(BufferedReaderTest, bigReadAfterSmallRead)
     EXPECT_FALSE(reader.eof());
 }
 
-TEST_F(BufferedReaderTest, readAfterSeek)
+TEST_P(BufferedReaderTest, readAfterSeek)
 {
     std::array<uint8_t, 2> readData;
     std::array<uint8_t, 10> bigReadData;
@@ -207,7 +208,7 @@ TEST_F(BufferedReaderTest, readAfterSeek)
     EXPECT_FALSE(reader.eof());
 }
 
-TEST_F(BufferedReaderTest, endOfFile)
+TEST_P(BufferedReaderTest, endOfFile)
 {
     std::array<uint8_t, 2> readData;
 
@@ -218,5 +219,146 @@ TEST_F(BufferedReaderTest, endOfFile)
     EXPECT_TRUE(reader.eof());
 }
 
+TEST_P(BufferedReaderTest, peekAndConsume)
+{
+    auto span = reader.peek(4);
+    ASSERT_EQ(4U, span.size);
+    EXPECT_EQ(0U, span.data[0]);
+    EXPECT_EQ(3U, span.data[3]);
+    EXPECT_EQ(0U, reader.currentPosition());
+
+    reader.consume(4);
+    EXPECT_EQ(4U, reader.currentPosition());
+
+    // crosses the end of the buffer, the remaining bytes are kept
+    reader.seekAbsolute(8);
+    span = reader.peek(6);
+    ASSERT_EQ(6U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + 8, span.data, span.size));
+    reader.consume(span.size);
+
+    std::array<uint8_t, 2> readData;
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(14U, readData[0]);
+    EXPECT_EQ(15U, readData[1]);
+}
+
+TEST_P(BufferedReaderTest, peekKeepsPositionWhenRefillFails)
+{
+    class FailingReader : public FileReader
+    {
+    public:
+        uint64_t read(uint8_t* pData, uint64_t size) override
+        {
+            if (fail)
+            {
+                throw std::runtime_error("read failed");
+            }
+
+            return FileReader::read(pData, size);
+        }
+
+        bool fail = false;
+    };
+
+    auto failingReader = std::make_unique<FailingReader>();
+    auto* source = failingReader.get();
+
+    // no read ahead, so the failure is not hidden by a block that was read before
+    BufferedReader bufferedReader(std::move(failingReader), 10, 0);
+    bufferedReader.open(g_testFile);
+
+    std::array<uint8_t, 5> readData;
+    EXPECT_EQ(readData.size(), bufferedReader.read(readData.data(), readData.size()));
+
+    source->fail = true;
+    EXPECT_THROW(bufferedReader.peek(8), std::runtime_error);
+    EXPECT_EQ(5U, bufferedReader.currentPosition());
+
+    source->fail = false;
+    auto span = bufferedReader.peek(8);
+    ASSERT_EQ(8U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + 5, span.data, span.size));
+}
+
+TEST_P(BufferedReaderTest, peekLargerThanBuffer)
+{
+    reader.seekAbsolute(20);
+    auto span = reader.peek(50);
+    ASSERT_EQ(50U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + 20, span.data, span.size));
+    EXPECT_EQ(20U, reader.currentPosition());
+}
+
+TEST_P(BufferedReaderTest, peekAtEndOfFile)
+{
+    reader.seekAbsolute(97);
+    auto span = reader.peek(10);
+    ASSERT_EQ(3U, span.size);
+    EXPECT_EQ(97U, span.data[0]);
+
+    reader.consume(span.size);
+    EXPECT_TRUE(reader.eof());
+    EXPECT_TRUE(reader.peek(10).empty());
+}
+
+TEST_P(BufferedReaderTest, readAfterEndOfFile)
+{
+    std::array<uint8_t, 8> readData;
+
+    reader.seekAbsolute(96);
+    EXPECT_EQ(4U, reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(0U, reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(100U, reader.currentPosition());
+}
+
+TEST_P(BufferedReaderTest, sequentialRead)
+{
+    std::vector<uint8_t> readData;
+    std::array<uint8_t, 3> chunk;
+
+    while (auto bytes = reader.read(chunk.data(), chunk.size()))
+    {
+        readData.insert(readData.end(), chunk.begin(), chunk.begin() + bytes);
+    }
+
+    EXPECT_EQ(data, readData);
+    EXPECT_TRUE(reader.eof());
+}
+
+TEST_P(BufferedReaderTest, sequentialPeek)
+{
+    std::vector<uint8_t> readData;
+
+    for (auto span = reader.peek(7); !span.empty(); span = reader.peek(7))
+    {
+        readData.insert(readData.end(), span.begin(), span.end());
+        reader.consume(span.size);
+    }
+
+    EXPECT_EQ(data, readData);
+}
+
+TEST_P(BufferedReaderTest, seekDuringSequentialRead)
+{
+    std::array<uint8_t, 4> readData;
+
+    for (uint64_t position = 0; position < 40; position += readData.size())
+    {
+        EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+        EXPECT_EQ(0, memcmp(data.data() + position, readData.data(), readData.size()));
+    }
+
+    // seek back into read ahead data and outside of it
+    for (uint64_t position : {35, 12, 90, 41, 0})
+    {
+        reader.seekAbsolute(position);
+        EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+        EXPECT_EQ(0, memcmp(data.data() + position, readData.data(), readData.size()));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(ReadAheadBuffers, BufferedReaderTest, Values(0u, 1u, 2u));
+
 }
 }
@@ -0,0 +1,197 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/csvparser.h"
+#include "utils/readerinterface.h"
+#include "src/simd.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+using namespace utils;
+using namespace utils::str;
+using namespace testing;
+
+using Rows = std::vector<std::vector<std::string>>;
+
+namespace
+{
+
+// Returns the data in chunks of at most chunkSize bytes
+class MemoryReader : public IReader
+{
+public:
+    MemoryReader(std::string data, size_t chunkSize)
+    : m_data(std::move(data))
+    , m_chunkSize(chunkSize)
+    {
+    }
+
+    void open(const std::string&) override {}
+    void close() override {}
+
+    uint64_t getContentLength() override { return m_data.size(); }
+    uint64_t currentPosition() override { return m_pos; }
+    bool eof() override { return m_pos == m_data.size(); }
+    std::string uri() override { return "memory"; }
+    void clearErrors() override {}
+
+    void seekAbsolute(uint64_t position) override { m_pos = std::min<uint64_t>(position, m_data.size()); }
+    void seekRelative(uint64_t offset) override { seekAbsolute(m_pos + offset); }
+
+    uint64_t read(uint8_t* pData, uint64_t size) override
+    {
+        auto bytes = std::min<uint64_t>({size, m_chunkSize, m_data.size() - m_pos});
+        std::memcpy(pData, m_data.data() + m_pos, bytes);
+        m_pos += bytes;
+        return bytes;
+    }
+
+    std::vector<uint8_t> readAllData() override
+    {
+        throw std::logic_error("not implemented");
+    }
+
+    ByteSpan peek(uint64_t size) override { return m_peekBuffer.peek(*this, size); }
+
+private:
+    std::string m_data;
+    size_t m_chunkSize;
+    uint64_t m_pos = 0;
+    PeekBuffer m_peekBuffer;
+};
+
+Rows parseRows(csv_parser& parser)
+{
+    Rows rows;
+    while (parser.read_row())
+    {
+        rows.emplace_back(parser.fields().begin(), parser.fields().end());
+    }
+
+    return rows;
+}
+
+Rows parse(std::string_view data, csv_options options = csv_options())
+{
+    csv_parser parser(data, options);
+    return parseRows(parser);
+}
+
+Rows parseChunked(const std::string& data, size_t readSize, csv_options options = csv_options())
+{
+    MemoryReader reader(data, readSize);
+    options.chunkSize = readSize;
+    csv_parser parser(reader, options);
+    return parseRows(parser);
+}
+
+}
+
+TEST(CsvParserTest, Unquoted)
+{
+    EXPECT_EQ(Rows({{"a", "b", "c"}, {"1", "2", "3"}}), parse("a,b,c\n1,2,3\n"));
+    EXPECT_EQ(Rows({{"a", "b", "c"}, {"1", "2", "3"}}), parse("a,b,c\r\n1,2,3"));
+    EXPECT_EQ(Rows({{"a"}, {"b"}}), parse("a\rb\r"));
+    EXPECT_EQ(Rows({{"", "", ""}}), parse(",,"));
+    EXPECT_EQ(Rows({{"a", ""}}), parse("a,\n"));
+    EXPECT_EQ(Rows(), parse(""));
+    EXPECT_EQ(Rows(), parse("\n\r\n"));
+}
+
+TEST(CsvParserTest, EmptyLinesAreSkipped)
+{
+    EXPECT_EQ(Rows({{"a"}, {"b"}}), parse("\na\n\n\r\nb\n\n"));
+}
+
+TEST(CsvParserTest, Quoted)
+{
+    EXPECT_EQ(Rows({{"a,b", "c\nd", ""}}), parse("\"a,b\",\"c\nd\",\"\""));
+    EXPECT_EQ(Rows({{"say \"hi\"", "x"}}), parse("\"say \"\"hi\"\"\",x\n"));
+    EXPECT_EQ(Rows({{"\""}}), parse("\"\"\"\""));
+
+    // quotes in the middle of a field are regular characters
+    EXPECT_EQ(Rows({{"a\"b", "c\""}}), parse("a\"b,c\""));
+
+    // characters after the closing quote are appended, unterminated quotes run until the end
+    EXPECT_EQ(Rows({{"ab c", "d"}}), parse("\"ab\" c,d"));
+    EXPECT_EQ(Rows({{"a", "b,c\n"}}), parse("a,\"b,c\n"));
+}
+
+TEST(CsvParserTest, FieldsPointIntoTheInput)
+{
+    std::string_view data = "abc,\"def\",\"g\"\"h\"";
+    csv_parser parser(data);
+    ASSERT_TRUE(parser.read_row());
+    ASSERT_EQ(3u, parser.fields().size());
+    EXPECT_EQ(data.data(), parser.fields()[0].data());
+    EXPECT_EQ(data.data() + 5, parser.fields()[1].data());
+    EXPECT_EQ("g\"h", parser.fields()[2]);
+    EXPECT_FALSE(parser.read_row());
+    EXPECT_EQ(1u, parser.row_count());
+}
+
+TEST(CsvParserTest, Tsv)
+{
+    csv_options options;
+    options.delimiter = '\t';
+    options.quoting   = false;
+
+    EXPECT_EQ(Rows({{"a", "\"b", "c,d\""}, {"1", "2", "3"}}), parse("a\t\"b\tc,d\"\n1\t2\t3\n", options));
+}
+
+TEST(CsvParserTest, ChunkBoundaries)
+{
+    const std::string data = "id,name,comment\n1,\"Smith, John\",\"said \"\"hello\"\"\"\r\n2,Doe,\n\n3,\"multi\nline\",x\r\n";
+    const auto expected    = parse(data);
+    ASSERT_EQ(4u, expected.size());
+
+    for (size_t readSize = 1; readSize < data.size() + 2; ++readSize)
+    {
+        EXPECT_EQ(expected, parseChunked(data, readSize)) << "read size " << readSize;
+    }
+}
+
+TEST(CsvParserTest, LargeRandomInputAllInstructionSets)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> charDist(0, 11);
+    const char chars[] = "abcxyz ,,\n\"\r";
+
+    std::string data;
+    for (int i = 0; i < 20000; ++i)
+    {
+        data += chars[charDist(rng)];
+    }
+
+    const auto detected = utils::simd::detectInstructionSet();
+    utils::simd::setInstructionSet(utils::simd::InstructionSet::Scalar);
+    const auto expected = parse(data);
+
+    for (auto set : {utils::simd::InstructionSet::Sse2, utils::simd::InstructionSet::Avx2})
+    {
+        utils::simd::setInstructionSet(set);
+        EXPECT_EQ(expected, parse(data));
+        EXPECT_EQ(expected, parseChunked(data, 100));
+        EXPECT_EQ(expected, parseChunked(data, 4096));
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
@@ -0,0 +1,186 @@
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+
+#include "utils/filereader.h"
+#include "utils/fileoperations.h"
+
+using namespace utils;
+using namespace testing;
+
+namespace utils
+{
+namespace test
+{
+
+static const std::string g_testFile = "filereadertestfile.bin";
+
+class FileReaderTest : public Test
+{
+protected:
+    void SetUp()
+    {
+        data.resize(100 * 1024);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        std::ofstream file(g_testFile, std::ios::binary);
+        EXPECT_TRUE(file.is_open());
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.close();
+
+        EXPECT_NO_THROW(reader.open(g_testFile));
+    }
+
+    void TearDown()
+    {
+        reader.close();
+        EXPECT_NO_THROW(fileops::deleteFile(g_testFile));
+    }
+
+    FileReader              reader;
+    std::vector<uint8_t>    data;
+};
+
+TEST_F(FileReaderTest, contentLength)
+{
+    EXPECT_EQ(data.size(), reader.getContentLength());
+}
+
+TEST_F(FileReaderTest, read)
+{
+    std::array<uint8_t, 16> readData;
+
+    reader.seekAbsolute(1000);
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(0, memcmp(data.data() + 1000, readData.data(), readData.size()));
+    EXPECT_EQ(1016U, reader.currentPosition());
+}
+
+TEST_F(FileReaderTest, peekAndConsume)
+{
+    auto span = reader.peek(10);
+    ASSERT_EQ(10U, span.size);
+    EXPECT_EQ(0, memcmp(data.data(), span.data, span.size));
+    EXPECT_EQ(0U, reader.currentPosition());
+
+    // served from the window that was read ahead
+    reader.consume(span.size);
+    auto next = reader.peek(20);
+    ASSERT_EQ(20U, next.size);
+    EXPECT_EQ(span.data + 10, next.data);
+    EXPECT_EQ(0, memcmp(data.data() + 10, next.data, next.size));
+
+    // read continues after the consumed data
+    reader.consume(next.size);
+    std::array<uint8_t, 4> readData;
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(0, memcmp(data.data() + 30, readData.data(), readData.size()));
+}
+
+TEST_F(FileReaderTest, peekOutsideWindow)
+{
+    reader.seekAbsolute(90 * 1024);
+    auto span = reader.peek(8 * 1024);
+    ASSERT_EQ(8U * 1024, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + 90 * 1024, span.data, span.size));
+
+    reader.seekAbsolute(10);
+    span = reader.peek(4);
+    ASSERT_EQ(4U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + 10, span.data, span.size));
+}
+
+TEST_F(FileReaderTest, peekAtEndOfFile)
+{
+    reader.seekAbsolute(data.size() - 5);
+    auto span = reader.peek(10);
+    ASSERT_EQ(5U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + data.size() - 5, span.data, span.size));
+
+    reader.consume(span.size);
+    EXPECT_TRUE(reader.peek(10).empty());
+}
+
+TEST_F(FileReaderTest, peekPastEndOfFileUsesWindow)
+{
+    reader.seekAbsolute(data.size() - 100);
+    auto span = reader.peek(200);
+    ASSERT_EQ(100U, span.size);
+
+    // overwrite the file, a peek that is served from the window still sees the old contents
+    std::vector<uint8_t> zeros(data.size(), 0);
+    std::ofstream file(g_testFile, std::ios::binary | std::ios::in);
+    file.write(reinterpret_cast<const char*>(zeros.data()), zeros.size());
+    file.close();
+
+    reader.consume(50);
+    span = reader.peek(200);
+    ASSERT_EQ(50U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + data.size() - 50, span.data, span.size));
+}
+
+// reader that peeks through a PeekBuffer and can fail its reads
+class CopyingReader : public FileReader
+{
+public:
+    uint64_t read(uint8_t* pData, uint64_t size) override
+    {
+        if (fail && currentPosition() >= 20)
+        {
+            throw std::runtime_error("read failed");
+        }
+
+        return FileReader::read(pData, std::min<uint64_t>(size, 16));
+    }
+
+    ByteSpan peek(uint64_t size) override
+    {
+        return m_peekBuffer.peek(*this, size);
+    }
+
+    bool fail = false;
+
+private:
+    PeekBuffer m_peekBuffer;
+};
+
+TEST_F(FileReaderTest, peekBuffer)
+{
+    CopyingReader copyingReader;
+    copyingReader.open(g_testFile);
+
+    // the reads are limited to 16 bytes, the peek combines them
+    copyingReader.seekAbsolute(10);
+    auto span = copyingReader.peek(40);
+    ASSERT_EQ(40U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + 10, span.data, span.size));
+    EXPECT_EQ(10U, copyingReader.currentPosition());
+
+    copyingReader.fail = true;
+    EXPECT_THROW(copyingReader.peek(40), std::runtime_error);
+    EXPECT_EQ(10U, copyingReader.currentPosition());
+}
+
+}
+}
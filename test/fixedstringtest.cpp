@@ -0,0 +1,162 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/fixedstring.h"
+#include "gtest/gtest.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace utils;
+using namespace testing;
+
+TEST(FixedStringTest, Construct)
+{
+    fixed_string<8> empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(0u, empty.size());
+    EXPECT_STREQ("", empty.c_str());
+
+    fixed_string<8> str = "abc";
+    EXPECT_EQ(3u, str.size());
+    EXPECT_STREQ("abc", str.c_str());
+    EXPECT_EQ(8u, str.capacity());
+
+    fixed_string<8> fromView(std::string_view("abcdefgh"));
+    EXPECT_EQ("abcdefgh", fromView);
+
+    EXPECT_EQ("xxx", fixed_string<8>(3, 'x'));
+    EXPECT_THROW(fixed_string<8>("abcdefghi"), std::length_error);
+
+    // no heap storage, only the characters, the terminator and a one byte size
+    EXPECT_EQ(33u, sizeof(fixed_string<31>));
+}
+
+TEST(FixedStringTest, Modify)
+{
+    fixed_string<8> str;
+    str += "abc";
+    str += 'd';
+    str.push_back('e');
+    str.append(2, 'f');
+    EXPECT_EQ("abcdeff", str);
+
+    str.pop_back();
+    EXPECT_EQ("abcdef", str);
+
+    str.resize(8, 'z');
+    EXPECT_EQ("abcdefzz", str);
+    EXPECT_THROW(str.push_back('x'), std::length_error);
+    EXPECT_THROW(str.append("x"), std::length_error);
+    EXPECT_EQ("abcdefzz", str);
+
+    str.resize(2);
+    EXPECT_STREQ("ab", str.c_str());
+
+    str = "xyz";
+    EXPECT_EQ("xyz", str);
+    str = std::string_view("uvw");
+    EXPECT_EQ("uvw", str);
+
+    str[0] = 'U';
+    EXPECT_EQ('U', str.front());
+    EXPECT_EQ('w', str.back());
+    EXPECT_EQ("Uvw", std::string(str.begin(), str.end()));
+
+    str.clear();
+    EXPECT_TRUE(str.empty());
+}
+
+TEST(FixedStringTest, Compare)
+{
+    fixed_string<8> abc = "abc";
+    fixed_string<16> abcLarge = "abc";
+
+    EXPECT_TRUE(abc == "abc");
+    EXPECT_TRUE("abc" == abc);
+    EXPECT_TRUE(abc == std::string("abc"));
+    EXPECT_TRUE(std::string_view("abc") == abc);
+    EXPECT_TRUE(abc == abcLarge);
+    EXPECT_TRUE(abc != "abd");
+    EXPECT_TRUE("abd" != abc);
+    EXPECT_TRUE(abc < "abd");
+    EXPECT_FALSE("abd" < abc);
+    EXPECT_TRUE(abc == fixed_string<8>("abc"));
+
+    std::map<fixed_string<8>, int> map;
+    map["b"] = 2;
+    map["a"] = 1;
+    EXPECT_EQ("a", map.begin()->first);
+
+    std::unordered_set<fixed_string<8>> set;
+    set.insert("key");
+    EXPECT_EQ(1u, set.count("key"));
+    EXPECT_EQ(std::hash<std::string>()("key"), std::hash<fixed_string<8>>()("key"));
+
+    std::ostringstream ss;
+    ss << abc;
+    EXPECT_EQ("abc", ss.str());
+}
+
+TEST(FixedStringTest, StringHelpers)
+{
+    fixed_string<16> str = "  Some Key \t";
+
+    EXPECT_EQ("Some Key", str::trim(str));
+    static_assert(std::is_same_v<fixed_string<16>, decltype(str::trim(str))>);
+
+    str::trim_in_place(str);
+    EXPECT_EQ("Some Key", str);
+
+    EXPECT_EQ("some key", str::lowercase(str));
+    EXPECT_EQ("SOME KEY", str::uppercase(str));
+    static_assert(std::is_same_v<fixed_string<16>, decltype(str::lowercase(str))>);
+
+    str::lowercase_in_place(str);
+    EXPECT_EQ("some key", str);
+    str::uppercase_in_place(str);
+    EXPECT_EQ("SOME KEY", str);
+
+    EXPECT_TRUE(str::iequals(str, "some key"));
+    EXPECT_EQ(2u, str::split(str, ' ').size());
+}
+
+TEST(FixedStringTest, ToString)
+{
+    EXPECT_EQ("42", str::toString<8>(42));
+    EXPECT_EQ("-1.5", str::toString<8>(-1.5));
+    EXPECT_EQ("18446744073709551615", str::toString<24>(UINT64_MAX));
+    EXPECT_EQ("text", str::toString<8>(std::string("text")));
+    EXPECT_THROW(str::toString<4>(123456), std::length_error);
+}
+
+TEST(FixedStringTest, JoinInto)
+{
+    fixed_string<32> result;
+    str::join_into(result, std::vector<std::string>{"a", "b", "c"}, ", ");
+    EXPECT_EQ("a, b, c", result);
+
+    result.clear();
+    str::join_into(result, std::vector<int>{1, 2, 3}, "-");
+    EXPECT_EQ("1-2-3", result);
+
+    fixed_string<4> tooSmall;
+    EXPECT_THROW(str::join_into(tooSmall, std::vector<std::string>{"abc", "def"}, ","), std::length_error);
+}
@@ -0,0 +1,208 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/hash.h"
+#include "utils/fileoperations.h"
+#include "utils/filereader.h"
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace utils;
+using namespace testing;
+
+namespace
+{
+
+std::string randomData(size_t size, uint32_t seed = 42)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    std::string result(size, '\0');
+    for (auto& c : result)
+    {
+        c = char(dist(rng));
+    }
+
+    return result;
+}
+
+}
+
+TEST(HashTest, StableValues)
+{
+    // the hashes may be persisted, so they must not change
+    EXPECT_EQ(0x93228a4de0eec5a2u, hash::hash64(""));
+    EXPECT_EQ(hash::hash64(std::string_view("abc")), hash::hash64("abc", 3));
+}
+
+TEST(HashTest, DifferentInputsDifferentHashes)
+{
+    auto data = randomData(300);
+
+    std::unordered_set<uint64_t> hashes;
+    for (size_t size = 0; size <= data.size(); ++size)
+    {
+        EXPECT_TRUE(hashes.insert(hash::hash64(data.data(), size)).second) << size;
+    }
+
+    // a single bit flip at any position changes the hash
+    for (size_t size : {1, 3, 4, 8, 15, 16, 17, 33, 48, 49, 64, 97, 300})
+    {
+        auto original = hash::hash64(data.data(), size);
+        for (size_t bit = 0; bit < size * 8; ++bit)
+        {
+            auto modified = data.substr(0, size);
+            modified[bit / 8] = char(modified[bit / 8] ^ (1 << (bit % 8)));
+            EXPECT_NE(original, hash::hash64(modified)) << size << ' ' << bit;
+        }
+    }
+
+    EXPECT_NE(hash::hash64(std::string_view("key"), 0), hash::hash64(std::string_view("key"), 1));
+}
+
+TEST(HashTest, NoCollisionsForSimilarKeys)
+{
+    std::unordered_set<uint64_t> hashes;
+    for (int i = 0; i < 100000; ++i)
+    {
+        EXPECT_TRUE(hashes.insert(hash::hash64("customer-" + std::to_string(i))).second);
+    }
+}
+
+TEST(HashTest, StreamingEqualsOneShot)
+{
+    auto data = randomData(400);
+
+    for (size_t size = 0; size <= data.size(); size += (size < 100 ? 1 : 13))
+    {
+        auto expected = hash::hash64(data.data(), size, 7);
+
+        // every split in two parts
+        for (size_t split = 0; split <= size; ++split)
+        {
+            hash::Hasher hasher(7);
+            hasher.update(data.data(), split);
+            hasher.update(data.data() + split, size - split);
+            ASSERT_EQ(expected, hasher.digest()) << size << ' ' << split;
+        }
+
+        // small updates of varying sizes
+        hash::Hasher hasher(7);
+        for (size_t pos = 0, chunk = 1; pos < size; pos += chunk, chunk = chunk % 61 + 1)
+        {
+            hasher.update(data.data() + pos, std::min(chunk, size - pos));
+        }
+        ASSERT_EQ(expected, hasher.digest()) << size;
+    }
+}
+
+TEST(HashTest, StreamingReset)
+{
+    hash::Hasher hasher;
+    hasher.update("some data that is discarded by the reset");
+    EXPECT_EQ(hash::hash64("some data that is discarded by the reset"), hasher.digest());
+
+    hasher.reset(3);
+    hasher.update("abc");
+    EXPECT_EQ(hash::hash64(std::string_view("abc"), 3), hasher.digest());
+
+    // digest does not finish the hasher
+    hasher.update("def");
+    EXPECT_EQ(hash::hash64(std::string_view("abcdef"), 3), hasher.digest());
+}
+
+TEST(HashTest, Reader)
+{
+    const std::string filename = "hashtestfile.bin";
+    auto data = randomData(200 * 1024 + 13);
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file.write(data.data(), data.size());
+    }
+
+    FileReader reader;
+    reader.open(filename);
+    EXPECT_EQ(hash::hash64(data), hash::hash64(reader));
+    reader.close();
+
+    fileops::deleteFile(filename);
+}
+
+TEST(HashTest, StringHash)
+{
+    hash::StringHash hasher;
+    EXPECT_EQ(hasher(std::string("key")), hasher(std::string_view("key")));
+    EXPECT_EQ(hasher("key"), hasher(std::string_view("key")));
+    EXPECT_EQ(static_cast<size_t>(hash::hash64("key")), hasher("key"));
+
+    std::unordered_map<std::string, int, hash::StringHash, hash::StringEqual> map;
+    map["one"] = 1;
+    map["two"] = 2;
+    EXPECT_EQ(1, map.at("one"));
+    EXPECT_EQ(2, map.at("two"));
+    EXPECT_EQ(map.end(), map.find("three"));
+}
+
+namespace
+{
+
+int dispatch(std::string_view method)
+{
+    using namespace hash::literals;
+
+    switch (hash::hash64(method))
+    {
+    case "GET"_hash:
+        return 1;
+    case "PUT"_hash:
+        return 2;
+    case "a method name that is longer than a stripe of 48 bytes"_hash:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+}
+
+TEST(HashTest, CompileTimeHash)
+{
+    using namespace hash::literals;
+
+    static_assert(hash::hash64("") == 0x93228a4de0eec5a2u);
+    static_assert("abc"_hash == hash::hash64(std::string_view("abc")));
+
+    // compile time and runtime hashes are equal for all the code paths
+    std::string runtime = "abc";
+    EXPECT_EQ("abc"_hash, hash::hash64(runtime));
+    runtime = "0123456789abcdef0123456789";
+    EXPECT_EQ("0123456789abcdef0123456789"_hash, hash::hash64(runtime));
+    runtime = "a string that is long enough to be processed in several stripes of 48 bytes";
+    EXPECT_EQ("a string that is long enough to be processed in several stripes of 48 bytes"_hash, hash::hash64(runtime));
+
+    EXPECT_EQ(1, dispatch("GET"));
+    EXPECT_EQ(2, dispatch(std::string("PUT")));
+    EXPECT_EQ(3, dispatch("a method name that is longer than a stripe of 48 bytes"));
+    EXPECT_EQ(0, dispatch("POST"));
+}
@@ -0,0 +1,372 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/log.h"
+#include "utils/logsink.h"
+#include "utils/fileoperations.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+namespace
+{
+
+// allocations of the current thread while counting is enabled
+thread_local bool   t_countAllocations = false;
+thread_local size_t t_allocations = 0;
+
+}
+
+void* operator new(std::size_t size)
+{
+    if (t_countAllocations)
+    {
+        ++t_allocations;
+    }
+
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+using namespace utils;
+using namespace testing;
+
+namespace
+{
+
+const std::string g_logFile = "logtestfile.log";
+
+class LogTest : public Test
+{
+protected:
+    void SetUp()
+    {
+        sink = std::make_shared<RingBufferSink>(10);
+        log::clearSinks();
+        log::addSink(sink);
+        log::setFilter(log::Level::Info);
+    }
+
+    void TearDown()
+    {
+        log::disableAsync();
+        log::clearSinks();
+        log::addSink(std::make_shared<ConsoleSink>());
+        log::setFilter(log::Level::Debug);
+    }
+
+    std::shared_ptr<RingBufferSink> sink;
+};
+
+void deleteLogFiles()
+{
+    for (auto& file : { g_logFile, g_logFile + ".1", g_logFile + ".2", g_logFile + ".3" })
+    {
+        try { fileops::deleteFile(file); } catch (std::exception&) {}
+    }
+}
+
+}
+
+TEST_F(LogTest, WriteToSink)
+{
+    log::info("Info {}", 1);
+    log::warn("Warn");
+    log::error("Error {} {}", "two", 2);
+    log::critical(std::string("Critical"));
+
+    auto messages = sink->messages();
+    ASSERT_EQ(4u, messages.size());
+    EXPECT_THAT(messages[0], StartsWith("INFO: ["));
+    EXPECT_THAT(messages[0], EndsWith("] Info 1"));
+    EXPECT_THAT(messages[1], StartsWith("WARN: ["));
+    EXPECT_THAT(messages[1], EndsWith("] Warn"));
+    EXPECT_THAT(messages[2], StartsWith("ERROR: ["));
+    EXPECT_THAT(messages[2], EndsWith("] Error two 2"));
+    EXPECT_THAT(messages[3], StartsWith("CRIT: ["));
+    EXPECT_THAT(messages[3], EndsWith("] Critical"));
+}
+
+TEST_F(LogTest, Filter)
+{
+    log::setFilter(log::Level::Error);
+    log::info("Info {}", 1);
+    log::warn("Warn");
+    log::error("Error");
+
+    auto messages = sink->messages();
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_THAT(messages[0], EndsWith("] Error"));
+}
+
+TEST_F(LogTest, RingBufferKeepsLastMessages)
+{
+    for (int i = 0; i < 15; ++i)
+    {
+        log::info("Message {}", i);
+    }
+
+    auto messages = sink->messages();
+    ASSERT_EQ(10u, messages.size());
+    EXPECT_THAT(messages.front(), EndsWith("] Message 5"));
+    EXPECT_THAT(messages.back(), EndsWith("] Message 14"));
+}
+
+TEST_F(LogTest, Async)
+{
+    log::enableAsync(4, log::OverflowPolicy::Block);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        log::info("Message {}", i);
+    }
+
+    log::flush();
+
+    auto messages = sink->messages();
+    ASSERT_EQ(10u, messages.size());
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_THAT(messages[i], EndsWith(fmt::format("] Message {}", i)));
+    }
+}
+
+TEST_F(LogTest, AsyncDropsMessagesWhenFull)
+{
+    auto largeSink = std::make_shared<RingBufferSink>(1000);
+    log::clearSinks();
+    log::addSink(largeSink);
+    log::enableAsync(2, log::OverflowPolicy::Drop);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        log::info("Message {}", i);
+    }
+
+    log::flush();
+
+    // every message is either written or counted as dropped
+    EXPECT_EQ(1000u, largeSink->messages().size() + log::droppedMessages());
+}
+
+TEST_F(LogTest, AsyncDeferredFormatting)
+{
+    log::enableAsync(16, log::OverflowPolicy::Block, log::FormatMode::Deferred);
+
+    UTILS_LOG_INFO("Numbers {} {} {}", 1, 2.5, 'c');
+    UTILS_LOG_WARN("Strings {}", std::string("are formatted immediately"));
+    log::disableAsync();
+
+    auto messages = sink->messages();
+    ASSERT_EQ(2u, messages.size());
+    EXPECT_THAT(messages[0], EndsWith("] Numbers 1 2.5 c"));
+    EXPECT_THAT(messages[1], EndsWith("] Strings are formatted immediately"));
+}
+
+TEST_F(LogTest, AsyncDeferredFormattingDoesNotAllocate)
+{
+    log::enableAsync(16, log::OverflowPolicy::Block, log::FormatMode::Deferred);
+
+    t_allocations = 0;
+    t_countAllocations = true;
+    UTILS_LOG_INFO("A format string that does not fit in the small string buffer: {} {}", 1, 2.5);
+    t_countAllocations = false;
+
+    // the format string and the arguments are only formatted on the writer thread
+    EXPECT_EQ(0u, t_allocations);
+
+    log::flush();
+    auto messages = sink->messages();
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_THAT(messages[0], EndsWith("] A format string that does not fit in the small string buffer: 1 2.5"));
+}
+
+// runtime format strings are always formatted immediately
+TEST_F(LogTest, AsyncDeferredFormattingRuntimeFormatString)
+{
+    log::enableAsync(16, log::OverflowPolicy::Block, log::FormatMode::Deferred);
+
+    {
+        auto format = std::make_unique<std::string>("Value from a runtime format string: {}");
+        log::info(format->c_str(), 42);
+
+        // the queued message must not refer to the format string
+        format->assign(format->size(), 'x');
+    }
+
+    log::flush();
+
+    auto messages = sink->messages();
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_THAT(messages[0], EndsWith("] Value from a runtime format string: 42"));
+}
+
+TEST_F(LogTest, RotatingFileSink)
+{
+    deleteLogFiles();
+
+    {
+        auto fileSink = std::make_shared<RotatingFileSink>(g_logFile, 100, std::chrono::seconds(0), 2);
+        log::addSink(fileSink);
+
+        for (int i = 0; i < 20; ++i)
+        {
+            log::info("Message {}", i);
+        }
+
+        log::removeSink(fileSink);
+    }
+
+    EXPECT_TRUE(fileops::pathExists(g_logFile));
+    EXPECT_TRUE(fileops::pathExists(g_logFile + ".1"));
+    EXPECT_TRUE(fileops::pathExists(g_logFile + ".2"));
+    EXPECT_FALSE(fileops::pathExists(g_logFile + ".3"));
+    EXPECT_LT(fileops::getFileSize(g_logFile + ".1"), 150u);
+
+    auto contents = fileops::readTextFile(g_logFile);
+    EXPECT_THAT(contents, EndsWith("] Message 19\n"));
+
+    deleteLogFiles();
+}
+
+TEST_F(LogTest, RotatingFileSinkFlushesErrorsImmediately)
+{
+    deleteLogFiles();
+
+    auto fileSink = std::make_shared<RotatingFileSink>(g_logFile, 0);
+    log::addSink(fileSink);
+
+    // synchronous logging never calls flush on the sinks
+    log::info("Buffered");
+    EXPECT_EQ(0u, fileops::getFileSize(g_logFile));
+
+    log::error("Flushed");
+    EXPECT_THAT(fileops::readTextFile(g_logFile), HasSubstr("] Flushed"));
+
+    log::removeSink(fileSink);
+    fileSink.reset();
+    deleteLogFiles();
+}
+
+TEST_F(LogTest, RotatingFileSinkSyncIntervalWithoutFlush)
+{
+    deleteLogFiles();
+
+    auto fileSink = std::make_shared<RotatingFileSink>(g_logFile, 0);
+    fileSink->setSyncInterval(std::chrono::milliseconds(1));
+    log::addSink(fileSink);
+
+    log::info("First");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    log::info("Second");
+    EXPECT_THAT(fileops::readTextFile(g_logFile), HasSubstr("] Second"));
+
+    log::removeSink(fileSink);
+    fileSink.reset();
+    deleteLogFiles();
+}
+
+TEST_F(LogTest, RotatingFileSinkSurvivesFailedRotation)
+{
+    const std::string dir = "logtestdir";
+    try { fileops::deleteDirectoryRecursive(dir); } catch (std::exception&) {}
+    fileops::createDirectory(dir);
+
+    auto fileSink = std::make_shared<RotatingFileSink>(dir + "/test.log", 50, std::chrono::seconds(0), 1);
+    log::addSink(fileSink);
+    log::info("Message before the directory is removed");
+
+    // the rotated file cannot be created anymore
+    fileops::deleteDirectoryRecursive(dir);
+    for (int i = 0; i < 10; ++i)
+    {
+        log::error("Message {}", i);
+    }
+
+    log::flush();
+    log::removeSink(fileSink);
+
+    // the other sinks still receive the messages
+    EXPECT_THAT(sink->messages().back(), EndsWith("] Message 9"));
+}
+
+TEST_F(LogTest, MacrosSkipArgumentEvaluation)
+{
+    int evaluations = 0;
+    auto value = [&] () { return ++evaluations; };
+
+    UTILS_LOG_INFO("Info {}", value());
+    UTILS_LOG_WARN("Warn");
+    log::setFilter(log::Level::Error);
+    UTILS_LOG_INFO("Info {}", value());
+    UTILS_LOG_DEBUG("Debug {}", value());
+
+    EXPECT_EQ(1, evaluations);
+
+    auto messages = sink->messages();
+    ASSERT_EQ(2u, messages.size());
+    EXPECT_THAT(messages[0], EndsWith("] Info 1"));
+    EXPECT_THAT(messages[1], EndsWith("] Warn"));
+}
+
+TEST_F(LogTest, ModuleFilter)
+{
+    static const log::Module network("network");
+    static const log::Module storage("storage");
+
+    EXPECT_NE(network.id(), storage.id());
+    EXPECT_EQ(network.id(), log::Module("network").id());
+
+    log::setFilter(log::Level::Warn);
+    log::setFilter(network, log::Level::Info);
+    log::setFilter("storage", log::Level::Critical);
+
+    UTILS_LOG_INFO_M(network, "Network info");
+    UTILS_LOG_ERROR_M(storage, "Storage error");
+    UTILS_LOG_CRITICAL_M(storage, "Storage critical");
+    UTILS_LOG_INFO("Info");
+
+    log::clearFilter(storage);
+    UTILS_LOG_ERROR_M(storage, "Storage error {}", 2);
+
+    log::clearFilter(network);
+    UTILS_LOG_INFO_M(network, "Network info {}", 2);
+
+    auto messages = sink->messages();
+    ASSERT_EQ(3u, messages.size());
+    EXPECT_THAT(messages[0], EndsWith("] Network info"));
+    EXPECT_THAT(messages[1], EndsWith("] Storage critical"));
+    EXPECT_THAT(messages[2], EndsWith("] Storage error 2"));
+}
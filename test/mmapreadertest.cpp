@@ -0,0 +1,194 @@
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "utils/mmapreader.h"
+#include "utils/readerfactory.h"
+#include "utils/fileoperations.h"
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+
+using namespace utils;
+using namespace testing;
+
+namespace utils
+{
+namespace test
+{
+
+static const std::string g_testFile = "mmapreadertestfile.bin";
+
+class MmapReaderTest : public Test
+{
+protected:
+    void SetUp()
+    {
+        data.resize(100);
+        for (int i = 0; i < 100; ++i)
+        {
+            data[i] = i;
+        }
+
+        writeFile(data);
+        EXPECT_NO_THROW(reader.open(g_testFile));
+    }
+
+    void TearDown()
+    {
+        reader.close();
+        EXPECT_NO_THROW(fileops::deleteFile(g_testFile));
+    }
+
+    void writeFile(const std::vector<uint8_t>& contents)
+    {
+        std::ofstream file(g_testFile, std::ios::binary | std::ios::trunc);
+        EXPECT_TRUE(file.is_open());
+        file.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+    }
+
+    MmapReader              reader;
+    std::vector<uint8_t>    data;
+};
+
+TEST_F(MmapReaderTest, contentLength)
+{
+    EXPECT_EQ(100U, reader.getContentLength());
+    EXPECT_EQ(g_testFile, reader.uri());
+}
+
+TEST_F(MmapReaderTest, read)
+{
+    std::array<uint8_t, 2> readData;
+
+    reader.seekAbsolute(3);
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(3U, readData[0]);
+    EXPECT_EQ(4U, readData[1]);
+    EXPECT_EQ(5U, reader.currentPosition());
+
+    reader.seekRelative(2);
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(7U, readData[0]);
+    EXPECT_EQ(8U, readData[1]);
+    EXPECT_FALSE(reader.eof());
+}
+
+TEST_F(MmapReaderTest, readPastEnd)
+{
+    std::array<uint8_t, 2> readData;
+
+    reader.seekAbsolute(99);
+    EXPECT_EQ(1U, reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(99U, readData[0]);
+    EXPECT_TRUE(reader.eof());
+
+    EXPECT_EQ(0U, reader.read(readData.data(), readData.size()));
+
+    reader.seekAbsolute(200);
+    EXPECT_EQ(0U, reader.read(readData.data(), readData.size()));
+
+    reader.seekAbsolute(0);
+    EXPECT_FALSE(reader.eof());
+}
+
+TEST_F(MmapReaderTest, readAllData)
+{
+    EXPECT_EQ(data, reader.readAllData());
+    EXPECT_TRUE(reader.eof());
+}
+
+TEST_F(MmapReaderTest, span)
+{
+    auto all = reader.data();
+    ASSERT_EQ(100U, all.size);
+    EXPECT_EQ(0, memcmp(data.data(), all.data, all.size));
+
+    auto part = reader.span(10, 5);
+    ASSERT_EQ(5U, part.size);
+    EXPECT_EQ(all.data + 10, part.data);
+    EXPECT_EQ(10U, *part.begin());
+
+    // clipped at the end of the file
+    EXPECT_EQ(4U, reader.span(96, 10).size);
+    EXPECT_TRUE(reader.span(100, 10).empty());
+
+    // the position is not modified
+    EXPECT_EQ(0U, reader.currentPosition());
+}
+
+TEST_F(MmapReaderTest, peek)
+{
+    reader.seekAbsolute(40);
+    auto span = reader.peek(8);
+    ASSERT_EQ(8U, span.size);
+    EXPECT_EQ(reader.data().data + 40, span.data);
+
+    reader.consume(span.size);
+    EXPECT_EQ(48U, reader.currentPosition());
+}
+
+TEST_F(MmapReaderTest, advise)
+{
+    EXPECT_NO_THROW(reader.advise(AccessPattern::Random));
+    EXPECT_NO_THROW(reader.advise(AccessPattern::WillNeed, 50, 10));
+    EXPECT_NO_THROW(reader.advise(AccessPattern::Normal, 200));
+}
+
+TEST_F(MmapReaderTest, emptyFile)
+{
+    reader.close();
+    writeFile({});
+
+    EXPECT_NO_THROW(reader.open(g_testFile));
+    EXPECT_EQ(0U, reader.getContentLength());
+    EXPECT_TRUE(reader.data().empty());
+    EXPECT_TRUE(reader.eof());
+    EXPECT_TRUE(reader.readAllData().empty());
+}
+
+TEST_F(MmapReaderTest, openNonExisting)
+{
+    MmapReader other;
+    EXPECT_THROW(other.open("doesnotexist.bin"), std::logic_error);
+}
+
+TEST_F(MmapReaderTest, factorySelectsMmapForLargeFiles)
+{
+    // memory mapping is opt-in
+    std::unique_ptr<IReader> defaultReader(ReaderFactory::create(g_testFile));
+    EXPECT_EQ(nullptr, dynamic_cast<MmapReader*>(defaultReader.get()));
+
+    ReaderFactory::setMmapThreshold(100);
+    std::unique_ptr<IReader> large(ReaderFactory::create(g_testFile));
+    EXPECT_NE(nullptr, dynamic_cast<MmapReader*>(large.get()));
+
+    ReaderFactory::setMmapThreshold(101);
+    std::unique_ptr<IReader> small(ReaderFactory::create(g_testFile));
+    EXPECT_EQ(nullptr, dynamic_cast<MmapReader*>(small.get()));
+
+    ReaderFactory::setMmapThreshold(UINT64_MAX);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,264 @@
+//    Copyright (C) 2014 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "utils/filereader.h"
+#include "utils/posixfilereader.h"
+#include "utils/readerfactory.h"
+#include "utils/fileoperations.h"
+
+#if !defined(WIN32) && !defined(__MINGW32__)
+
+using namespace utils;
+using namespace testing;
+
+namespace utils
+{
+namespace test
+{
+
+static const std::string g_testFile = "posixfilereadertestfile.bin";
+
+class PosixFileReaderTest : public TestWithParam<IoMode>
+{
+protected:
+    PosixFileReaderTest()
+    : reader(GetParam())
+    {
+    }
+
+    void SetUp()
+    {
+        // not a multiple of the direct io alignment
+        data.resize(100 * 1024 + 123);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<uint8_t>(i * 7 + i / 256);
+        }
+
+        std::ofstream file(g_testFile, std::ios::binary);
+        EXPECT_TRUE(file.is_open());
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.close();
+
+        EXPECT_NO_THROW(reader.open(g_testFile));
+    }
+
+    void TearDown()
+    {
+        reader.close();
+        EXPECT_NO_THROW(fileops::deleteFile(g_testFile));
+    }
+
+    PosixFileReader         reader;
+    std::vector<uint8_t>    data;
+};
+
+TEST_P(PosixFileReaderTest, contentLength)
+{
+    EXPECT_EQ(data.size(), reader.getContentLength());
+    EXPECT_EQ(g_testFile, reader.uri());
+
+    if (GetParam() == IoMode::Cached)
+    {
+        EXPECT_EQ(IoMode::Cached, reader.mode());
+    }
+}
+
+TEST_P(PosixFileReaderTest, read)
+{
+    std::array<uint8_t, 10> readData;
+
+    reader.seekAbsolute(1001);
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(0, memcmp(data.data() + 1001, readData.data(), readData.size()));
+
+    reader.seekRelative(5);
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(0, memcmp(data.data() + 1016, readData.data(), readData.size()));
+    EXPECT_EQ(1026U, reader.currentPosition());
+    EXPECT_FALSE(reader.eof());
+}
+
+TEST_P(PosixFileReaderTest, readPastEnd)
+{
+    std::array<uint8_t, 10> readData;
+
+    reader.seekAbsolute(data.size() - 4);
+    EXPECT_EQ(4U, reader.read(readData.data(), readData.size()));
+    EXPECT_EQ(0, memcmp(data.data() + data.size() - 4, readData.data(), 4));
+    EXPECT_TRUE(reader.eof());
+    EXPECT_EQ(0U, reader.read(readData.data(), readData.size()));
+
+    // no error state to clear
+    reader.seekAbsolute(0);
+    EXPECT_FALSE(reader.eof());
+    EXPECT_EQ(readData.size(), reader.read(readData.data(), readData.size()));
+}
+
+TEST_P(PosixFileReaderTest, readAllData)
+{
+    reader.seekAbsolute(50);
+    EXPECT_EQ(data, reader.readAllData());
+    EXPECT_TRUE(reader.eof());
+}
+
+TEST_P(PosixFileReaderTest, readLarge)
+{
+    // aligned buffer and position: the aligned part does not go through the window
+    void* ptr = nullptr;
+    ASSERT_EQ(0, posix_memalign(&ptr, PosixFileReader::DirectIoAlignment, data.size() + PosixFileReader::DirectIoAlignment));
+    std::unique_ptr<uint8_t, decltype(&free)> buffer(static_cast<uint8_t*>(ptr), &free);
+
+    reader.seekAbsolute(PosixFileReader::DirectIoAlignment);
+    auto expected = data.size() - PosixFileReader::DirectIoAlignment;
+    EXPECT_EQ(expected, reader.read(buffer.get(), data.size()));
+    EXPECT_EQ(0, memcmp(data.data() + PosixFileReader::DirectIoAlignment, buffer.get(), expected));
+    EXPECT_TRUE(reader.eof());
+
+    // unaligned buffer and position, larger than the read window
+    reader.seekAbsolute(3);
+    EXPECT_EQ(data.size() - 3, reader.read(buffer.get() + 1, data.size()));
+    EXPECT_EQ(0, memcmp(data.data() + 3, buffer.get() + 1, data.size() - 3));
+    EXPECT_TRUE(reader.eof());
+}
+
+TEST_P(PosixFileReaderTest, peekAndConsume)
+{
+    reader.seekAbsolute(4000);
+    auto span = reader.peek(200);
+    ASSERT_EQ(200U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + 4000, span.data, span.size));
+    EXPECT_EQ(4000U, reader.currentPosition());
+
+    reader.consume(span.size);
+    auto next = reader.peek(100);
+    ASSERT_EQ(100U, next.size);
+    EXPECT_EQ(span.data + 200, next.data);
+
+    reader.seekAbsolute(data.size() - 10);
+    EXPECT_EQ(10U, reader.peek(100).size);
+    reader.consume(10);
+    EXPECT_TRUE(reader.peek(100).empty());
+}
+
+TEST_P(PosixFileReaderTest, peekPastEndOfFileUsesWindow)
+{
+    reader.seekAbsolute(data.size() - 100);
+    auto span = reader.peek(200);
+    ASSERT_EQ(100U, span.size);
+
+    // overwrite the file, a peek that is served from the window still sees the old contents
+    std::vector<uint8_t> zeros(data.size(), 0);
+    std::ofstream file(g_testFile, std::ios::binary | std::ios::in);
+    file.write(reinterpret_cast<const char*>(zeros.data()), zeros.size());
+    file.close();
+
+    reader.consume(50);
+    span = reader.peek(200);
+    ASSERT_EQ(50U, span.size);
+    EXPECT_EQ(0, memcmp(data.data() + data.size() - 50, span.data, span.size));
+}
+
+TEST_P(PosixFileReaderTest, readAtDoesNotChangePosition)
+{
+    void* ptr = nullptr;
+    ASSERT_EQ(0, posix_memalign(&ptr, PosixFileReader::DirectIoAlignment, 2 * PosixFileReader::DirectIoAlignment));
+    std::unique_ptr<uint8_t, decltype(&free)> buffer(static_cast<uint8_t*>(ptr), &free);
+
+    reader.seekAbsolute(10);
+    EXPECT_EQ(8192U, reader.readAt(4096, buffer.get(), 8192));
+    EXPECT_EQ(0, memcmp(data.data() + 4096, buffer.get(), 8192));
+    EXPECT_EQ(10U, reader.currentPosition());
+
+    // short read at the end of the file
+    auto lastBlock = data.size() - (data.size() % 4096);
+    EXPECT_EQ(123U, reader.readAt(lastBlock, buffer.get(), 4096));
+    EXPECT_EQ(0, memcmp(data.data() + lastBlock, buffer.get(), 123));
+}
+
+TEST_P(PosixFileReaderTest, concurrentReadAt)
+{
+    constexpr uint64_t blockSize = 4096;
+    const auto blockCount = data.size() / blockSize;
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4, 0);
+    for (size_t t = 0; t < failures.size(); ++t)
+    {
+        threads.emplace_back([&, t] () {
+            void* ptr = nullptr;
+            if (posix_memalign(&ptr, blockSize, blockSize) != 0)
+            {
+                ++failures[t];
+                return;
+            }
+
+            for (int iteration = 0; iteration < 10; ++iteration)
+            {
+                for (size_t block = t; block < blockCount; block += failures.size())
+                {
+                    auto bytes = reader.readAt(block * blockSize, static_cast<uint8_t*>(ptr), blockSize);
+                    if (bytes != blockSize || memcmp(data.data() + block * blockSize, ptr, blockSize) != 0)
+                    {
+                        ++failures[t];
+                    }
+                }
+            }
+
+            free(ptr);
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(std::vector<int>(failures.size(), 0), failures);
+}
+
+TEST_P(PosixFileReaderTest, openNonExisting)
+{
+    PosixFileReader other(GetParam());
+    EXPECT_THROW(other.open("doesnotexist.bin"), std::logic_error);
+}
+
+TEST_P(PosixFileReaderTest, factorySelectsPositionalReadsWhenEnabled)
+{
+    std::unique_ptr<IReader> defaultReader(ReaderFactory::create(g_testFile));
+    EXPECT_NE(nullptr, dynamic_cast<FileReader*>(defaultReader.get()));
+
+    ReaderFactory::setPositionalReads(true);
+    std::unique_ptr<IReader> positional(ReaderFactory::create(g_testFile));
+    EXPECT_NE(nullptr, dynamic_cast<PosixFileReader*>(positional.get()));
+
+    ReaderFactory::setPositionalReads(false);
+}
+
+INSTANTIATE_TEST_CASE_P(IoModes, PosixFileReaderTest, Values(IoMode::Cached, IoMode::Direct));
+
+}
+}
+
+#endif
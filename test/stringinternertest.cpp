@@ -0,0 +1,147 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/stringinterner.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace utils;
+using namespace testing;
+
+TEST(StringInternerTest, SameStringSameHandle)
+{
+    StringInterner interner;
+
+    auto be1 = interner.intern("BE");
+    auto be2 = interner.intern(std::string("BE"));
+    auto nl  = interner.intern("NL");
+
+    EXPECT_EQ(be1, be2);
+    EXPECT_NE(be1, nl);
+    EXPECT_EQ(be1.view().data(), be2.view().data());
+    EXPECT_EQ("BE", be1.view());
+    EXPECT_STREQ("NL", nl.c_str());
+    EXPECT_EQ(2u, interner.size());
+}
+
+TEST(StringInternerTest, EmptyAndInvalid)
+{
+    StringInterner interner;
+
+    InternedString invalid;
+    EXPECT_FALSE(invalid.valid());
+    EXPECT_TRUE(invalid.empty());
+    EXPECT_EQ("", invalid.view());
+
+    auto empty = interner.intern("");
+    EXPECT_TRUE(empty.valid());
+    EXPECT_TRUE(empty.empty());
+    EXPECT_NE(invalid, empty);
+    EXPECT_EQ(empty, interner.intern(std::string_view()));
+}
+
+TEST(StringInternerTest, Find)
+{
+    StringInterner interner;
+
+    EXPECT_FALSE(interner.find("status").valid());
+    auto status = interner.intern("status");
+    EXPECT_EQ(status, interner.find("status"));
+    EXPECT_FALSE(interner.find("statu").valid());
+    EXPECT_FALSE(interner.find(std::string("status\0", 7)).valid());
+}
+
+TEST(StringInternerTest, HandlesAreStableWhileGrowing)
+{
+    StringInterner interner(1);
+
+    std::vector<InternedString> handles;
+    for (int i = 0; i < 10000; ++i)
+    {
+        handles.push_back(interner.intern("value" + std::to_string(i)));
+    }
+
+    EXPECT_EQ(10000u, interner.size());
+
+    std::unordered_set<InternedString> unique(handles.begin(), handles.end());
+    EXPECT_EQ(10000u, unique.size());
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ("value" + std::to_string(i), handles[i].view());
+        EXPECT_EQ(handles[i], interner.intern("value" + std::to_string(i)));
+    }
+}
+
+TEST(StringInternerTest, ManyShards)
+{
+    // the shard and slot are taken from different bits of the hash, also for more than 256 shards
+    StringInterner interner(1000);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        interner.intern("value" + std::to_string(i));
+    }
+
+    EXPECT_EQ(10000u, interner.size());
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ("value" + std::to_string(i), interner.find("value" + std::to_string(i)).view());
+    }
+}
+
+TEST(StringInternerTest, ConcurrentInterning)
+{
+    StringInterner interner(4);
+
+    constexpr int threadCount = 4;
+    constexpr int stringCount = 1000;
+
+    std::vector<std::vector<InternedString>> results(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < stringCount; ++i)
+            {
+                // every thread interns the same strings in a different order
+                auto index = (i * (t + 1) * 7919) % stringCount;
+                results[t].push_back(interner.intern("token" + std::to_string(index)));
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(size_t(stringCount), interner.size());
+    for (int t = 0; t < threadCount; ++t)
+    {
+        for (int i = 0; i < stringCount; ++i)
+        {
+            auto index = (i * (t + 1) * 7919) % stringCount;
+            EXPECT_EQ(interner.find("token" + std::to_string(index)), results[t][i]);
+        }
+    }
+}
@@ -15,12 +15,19 @@
 //    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <vector>
 
 #include "utils/stringoperations.h"
+#include "src/simd.h"
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
+
 using std::string;
 using std::string_view;
 using std::vector;
@@ -71,6 +78,84 @@ TEST(StringOperationsTest, UpperCase)
     EXPECT_EQ(std::string("HELLO"), uppercase("HeLLo"));
 }
 
+TEST(StringOperationsTest, CaseConversionAllInstructionSets)
+{
+    // every byte value, long enough to go through the vectorized and the scalar tail code paths
+    std::string allBytes;
+    for (int i = 0; i < 256 * 3; ++i)
+    {
+        allBytes += static_cast<char>(i % 256);
+    }
+
+    std::string expectedLower = allBytes;
+    std::string expectedUpper = allBytes;
+    for (auto& c : expectedLower)
+    {
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    }
+
+    for (auto& c : expectedUpper)
+    {
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    }
+
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : {utils::simd::InstructionSet::Scalar, utils::simd::InstructionSet::Sse2, utils::simd::InstructionSet::Avx2})
+    {
+        utils::simd::setInstructionSet(set);
+
+        EXPECT_EQ(expectedLower, lowercase(allBytes));
+        EXPECT_EQ(expectedUpper, uppercase(allBytes));
+
+        auto inPlace = allBytes;
+        lowercase_in_place(inPlace);
+        EXPECT_EQ(expectedLower, inPlace);
+        uppercase_in_place(inPlace);
+        EXPECT_EQ(expectedUpper, inPlace);
+
+        // multi-byte UTF-8 sequences are left untouched
+        EXPECT_EQ(u8"\u00c9t\u00e9 \u00c0 paris", lowercase(u8"\u00c9T\u00e9 \u00c0 PARIS"));
+        EXPECT_EQ(u8"\u00c9T\u00e9 \u00c0 PARIS", uppercase(u8"\u00c9t\u00e9 \u00c0 paris"));
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+TEST(StringOperationsTest, CaseInsensitiveComparison)
+{
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : {utils::simd::InstructionSet::Scalar, utils::simd::InstructionSet::Sse2, utils::simd::InstructionSet::Avx2})
+    {
+        utils::simd::setInstructionSet(set);
+
+        EXPECT_TRUE(iequals("", ""));
+        EXPECT_TRUE(iequals("Content-Length", "content-length"));
+        EXPECT_TRUE(iequals("A very long header name that spans multiple blocks", "a VERY long HEADER name that spans MULTIPLE blocks"));
+        EXPECT_FALSE(iequals("A very long header name that spans multiple blocks", "a VERY long HEADER name that spans MULTIPLE blockz"));
+        EXPECT_FALSE(iequals("abc", "abcd"));
+        EXPECT_FALSE(iequals("[", "{"));
+        EXPECT_FALSE(iequals("@", "`"));
+
+        EXPECT_TRUE(istarts_with("Content-Type: text/html", "content-type"));
+        EXPECT_TRUE(istarts_with("abc", ""));
+        EXPECT_FALSE(istarts_with("abc", "abcd"));
+        EXPECT_FALSE(istarts_with("Content-Type", "content-length"));
+
+        std::string haystack(100, 'x');
+        haystack += "Transfer-Encoding: Chunked";
+        EXPECT_EQ(100u, ifind(haystack, "transfer-encoding"));
+        EXPECT_EQ(119u, ifind(haystack, "CHUNKED"));
+        EXPECT_EQ(100u, ifind(haystack, "T"));
+        EXPECT_EQ(1u, ifind(haystack, "XX", 1));
+        EXPECT_EQ(haystack.size(), ifind(haystack, "", haystack.size()));
+        EXPECT_EQ(std::string_view::npos, ifind(haystack, "chunked!"));
+        EXPECT_EQ(std::string_view::npos, ifind(haystack, "x", haystack.size() + 1));
+        EXPECT_EQ(std::string_view::npos, ifind("ab", "abc"));
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
 TEST(StringOperationsTest, Dos2Unix)
 {
     string testString = "abcde\r\nfgs\r\r\n";
@@ -95,6 +180,105 @@ TEST(StringOperationsTest, Replace)
     testString = "stringstringstring";
     replace(testString, "stringstring", "string");
     EXPECT_EQ("stringstring", testString);
+
+    testString = "a.b.c";
+    replace(testString, ".", "...");
+    EXPECT_EQ("a...b...c", testString);
+
+    testString = "..";
+    replace(testString, ".", "<>");
+    EXPECT_EQ("<><>", testString);
+
+    testString = "aXbXc";
+    replace(testString, "X", "");
+    EXPECT_EQ("abc", testString);
+
+    testString = "abc";
+    replace(testString, "", "x");
+    EXPECT_EQ("abc", testString);
+    replace(testString, "d", "x");
+    EXPECT_EQ("abc", testString);
+}
+
+static std::string replaceReference(std::string str, std::string_view from, std::string_view to)
+{
+    for (size_t pos = 0; (pos = str.find(from, pos)) != std::string::npos; pos += to.size())
+    {
+        str.replace(pos, from.size(), to);
+    }
+
+    return str;
+}
+
+TEST(StringOperationsTest, ReplaceMatchesReference)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> charDist('a', 'c');
+
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string input(i, ' ');
+        for (auto& c : input)
+        {
+            c = static_cast<char>(charDist(rng));
+        }
+
+        for (auto [from, to] : {std::pair<string_view, string_view>{"a", "bb"}, {"ab", "c"}, {"abc", ""}, {"aa", "aa"}, {"b", "abc"}})
+        {
+            auto result = input;
+            replace(result, from, to);
+            EXPECT_EQ(replaceReference(input, from, to), result) << input << " " << from << " " << to;
+        }
+    }
+}
+
+TEST(StringOperationsTest, ReplaceAll)
+{
+    EXPECT_EQ("Hello John, today is monday", replace_all("Hello {{name}}, today is {{day}}", {{"{{name}}", "John"}, {"{{day}}", "monday"}}));
+    EXPECT_EQ("", replace_all("", {{"a", "b"}}));
+    EXPECT_EQ("abc", replace_all("abc", {}));
+    EXPECT_EQ("abc", replace_all("abc", {{"", "x"}}));
+
+    // swapping works because replacements are not rescanned
+    EXPECT_EQ("ba", replace_all("ab", {{"a", "b"}, {"b", "a"}}));
+
+    // leftmost match first, longest match on the same position
+    EXPECT_EQ("X", replace_all("abcd", {{"bc", "Y"}, {"abcd", "X"}}));
+    EXPECT_EQ("Xd", replace_all("abcd", {{"abc", "X"}, {"ab", "Y"}}));
+    EXPECT_EQ("aY", replace_all("abc", {{"bc", "Y"}, {"abcd", "X"}}));
+    EXPECT_EQ("YYa", replace_all("aaaaa", {{"aa", "Y"}}));
+    EXPECT_EQ("<p>a &amp; b&lt;&gt;</p>", replace_all("<p>a & b<></p>", {{"&", "&amp;"}, {"<>", "&lt;&gt;"}}));
+
+    // duplicate patterns: the first one wins
+    EXPECT_EQ("1", replace_all("a", {{"a", "1"}, {"a", "2"}}));
+
+    replacer placeholders({{"$1", "one"}, {"$2", "two"}, {"$10", "ten"}});
+    std::string output = "> ";
+    placeholders.replace("$1 $2 $10 $3", output);
+    EXPECT_EQ("> one two ten $3", output);
+    EXPECT_EQ("ten", placeholders.replace("$10"));
+}
+
+TEST(StringOperationsTest, ReplaceAllMatchesSinglePattern)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> charDist('a', 'c');
+
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string input(i, ' ');
+        for (auto& c : input)
+        {
+            c = static_cast<char>(charDist(rng));
+        }
+
+        for (auto [from, to] : {std::pair<string_view, string_view>{"a", "bb"}, {"ab", "c"}, {"abca", ""}, {"aa", "a"}})
+        {
+            auto expected = input;
+            replace(expected, from, to);
+            EXPECT_EQ(expected, replace_all(input, {{from, to}})) << input << " " << from << " " << to;
+        }
+    }
 }
 
 TEST(StringOperationsTest, Split)
@@ -253,12 +437,397 @@ TEST(StringOperationsTest, SplittedView)
     EXPECT_EQ("", tokenized[0]);
 }
 
+TEST(StringOperationsTest, SplitLeadingAndTrailingDelimiters)
+{
+    // a trailing character delimiter only ends a token when the token before it was empty
+    EXPECT_EQ(vector<string_view>({"a"}), splitted_view("a,", ','));
+    EXPECT_EQ(vector<string_view>({"", "a"}), splitted_view(",a", ','));
+    EXPECT_EQ(vector<string_view>({"", "a"}), splitted_view(",a,", ','));
+    EXPECT_EQ(vector<string_view>({"a", "b"}), splitted_view("a,b,", ','));
+    EXPECT_EQ(vector<string_view>({"a", "", ""}), splitted_view("a,,", ','));
+    EXPECT_EQ(vector<string_view>({"", ""}), splitted_view(",", ','));
+    EXPECT_EQ(vector<string_view>({""}), splitted_view("", ','));
+
+    // every string delimiter ends a token
+    EXPECT_EQ(vector<string_view>({"a", ""}), splitted_view("a::", "::"));
+    EXPECT_EQ(vector<string_view>({"", "a"}), splitted_view("::a", "::"));
+    EXPECT_EQ(vector<string_view>({"a", "b", ""}), splitted_view("a::b::", "::"));
+
+    EXPECT_EQ(vector<string>({"a"}), split("a,", ','));
+    EXPECT_EQ(vector<string>({"", "a"}), split(",a", ','));
+    EXPECT_EQ(vector<string>({"a", ""}), split("a::", std::string("::")));
+}
+
+TEST(StringOperationsTest, SplitNoEmptyOnlyDelimiters)
+{
+    // the input is the only token when the options remove all tokens of a character split
+    EXPECT_EQ(vector<string_view>({",,"}), splitted_view(",,", ',', split_opt::no_empty));
+    EXPECT_EQ(vector<string_view>({","}), splitted_view(" , ", ',', split_opt::trim | split_opt::no_empty));
+    EXPECT_EQ(vector<string_view>(), splitted_view("", ',', split_opt::no_empty));
+    EXPECT_EQ(vector<string>({",,"}), split(",,", ',', split_opt::no_empty));
+    EXPECT_EQ(vector<string>(), split("::::", std::string("::"), split_opt::no_empty));
+    EXPECT_EQ(vector<string_view>({"a"}), splitted_view("a,", ',', split_opt::no_empty));
+}
+
+// the scalar implementation that preceded the vectorized one
+static vector<string_view> referenceSplit(string_view str, char delimiter, utils::flags<split_opt> opt)
+{
+    vector<string_view> tokens;
+
+    auto addToken = [&] (string_view token) {
+        if (opt.is_set(split_opt::trim))
+        {
+            token = trimmed_view(token);
+        }
+
+        if (!opt.is_set(split_opt::no_empty) || !token.empty())
+        {
+            tokens.push_back(token);
+        }
+    };
+
+    size_t      length = 0;
+    const char* start  = str.data();
+    for (size_t i = 0; i < str.size(); ++i)
+    {
+        if (str[i] == delimiter)
+        {
+            addToken(string_view(start, length));
+            length = 0;
+
+            if (i + 1 < str.size())
+            {
+                start = &str[i + 1];
+            }
+        }
+        else
+        {
+            ++length;
+        }
+    }
+
+    if (length > 0)
+    {
+        addToken(string_view(start, length));
+    }
+
+    if (!str.empty() && *start == delimiter)
+    {
+        addToken(string_view());
+    }
+
+    if (tokens.empty())
+    {
+        addToken(str);
+    }
+
+    return tokens;
+}
+
+TEST(StringOperationsTest, SplittedViewAllInstructionSets)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> charDist(0, 5);
+    const char alphabet[] = {'a', 'b', ' ', ',', ',', '\t'};
+
+    std::vector<string> inputs = {"", ",", ",,", "a,", ",a", string(64, ','), string(63, 'a') + ",", string(64, 'a') + ","};
+    for (auto length : {1, 15, 63, 64, 65, 127, 128, 200, 1000})
+    {
+        string input;
+        for (int i = 0; i < length; ++i)
+        {
+            input += alphabet[charDist(rng)];
+        }
+
+        inputs.push_back(input);
+    }
+
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : {utils::simd::InstructionSet::Scalar, utils::simd::InstructionSet::Sse2, utils::simd::InstructionSet::Avx2})
+    {
+        utils::simd::setInstructionSet(set);
+
+        for (auto& input : inputs)
+        {
+            for (auto opt : {utils::flags<split_opt>(), utils::flags<split_opt>(split_opt::trim), split_opt::trim | split_opt::no_empty})
+            {
+                EXPECT_EQ(referenceSplit(input, ',', opt), splitted_view(input, ',', opt)) << input;
+            }
+        }
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+template <typename Range>
+static vector<string_view> collect(const Range& range)
+{
+    return vector<string_view>(range.begin(), range.end());
+}
+
+TEST(StringOperationsTest, SplitRange)
+{
+    EXPECT_EQ(vector<string_view>({"A", "B", "C"}), collect(split_range("A-B-C", '-')));
+    EXPECT_EQ(vector<string_view>({"", ""}), collect(split_range(";", ';')));
+    EXPECT_EQ(vector<string_view>({""}), collect(split_range("", ';')));
+    EXPECT_EQ(vector<string_view>({"string"}), collect(split_range("string", ',')));
+    EXPECT_EQ(vector<string_view>({"A", "", "C"}), collect(split_range("A,,C,", ',')));
+    EXPECT_EQ(vector<string_view>({"A", "", ""}), collect(split_range("A,,", ',')));
+
+    EXPECT_EQ(vector<string_view>({"A", "B", "C"}), collect(split_range("A_*_B_*_C", "_*_")));
+    EXPECT_EQ(vector<string_view>({"A_*_B_*_C"}), collect(split_range("A_*_B_*_C", "_**_")));
+    EXPECT_EQ(vector<string_view>({"A_*_B_*", ""}), collect(split_range("A_*_B_*_C", "_C")));
+    EXPECT_EQ(vector<string_view>({"abc"}), collect(split_range("abc", "")));
+
+    EXPECT_EQ(vector<string_view>({"A", "B", "", "C"}), collect(split_range("A,B;;C", any_of(",;"))));
+    EXPECT_EQ(vector<string_view>({"A", "B"}), collect(split_range("A,B;", any_of(",;"))));
+}
+
+TEST(StringOperationsTest, SplitRangeTemporaryDelimiter)
+{
+    // the range keeps a copy of a temporary delimiter, it is destroyed before the loop body runs
+    std::string delimiter(40, '-');
+    std::string input = "A" + delimiter + "B" + delimiter + "C";
+
+    vector<string_view> tokens;
+    for (auto token : split_range(input, std::string(delimiter)))
+    {
+        tokens.push_back(token);
+    }
+
+    EXPECT_EQ(vector<string_view>({"A", "B", "C"}), tokens);
+
+    // lvalue strings are not copied
+    EXPECT_EQ(vector<string_view>({"A", "B", "C"}), collect(split_range(input, delimiter)));
+    static_assert(std::is_same_v<decltype(split_range(input, delimiter)), split_range<string_delimiter>>);
+    static_assert(std::is_same_v<decltype(split_range(input, std::string(delimiter))), split_range<owned_string_delimiter>>);
+}
+
+TEST(StringOperationsTest, SplitRangeOptions)
+{
+    EXPECT_EQ(vector<string_view>({"A", "C"}), collect(split_range(" A,  ,C  ", ',', split_opt::trim | split_opt::no_empty)));
+    EXPECT_EQ(vector<string_view>({"A", "", "C"}), collect(split_range(" A,  ,C  ", ',', split_opt::trim)));
+    EXPECT_EQ(vector<string_view>({"A", "C"}), collect(split_range(" A , , ,  C  ", ", ", split_opt::trim | split_opt::no_empty)));
+    EXPECT_EQ(vector<string_view>(), collect(split_range("", ',', split_opt::no_empty)));
+    EXPECT_EQ(vector<string_view>({",,,"}), collect(split_range(",,,", ',', split_opt::no_empty)));
+    EXPECT_EQ(vector<string_view>(), collect(split_range("::", "::", split_opt::no_empty)));
+}
+
+TEST(StringOperationsTest, SplitRangeMatchesSplittedView)
+{
+    for (auto input : {"", ",", ",,", "a,", "a,,", "a,b", ",a,,b,", " a , b ,, c ", " , "})
+    {
+        for (auto opt : {utils::flags<split_opt>(), utils::flags<split_opt>(split_opt::trim), split_opt::trim | split_opt::no_empty})
+        {
+            EXPECT_EQ(splitted_view(input, ',', opt), collect(split_range(input, ',', opt)));
+        }
+    }
+}
+
+TEST(StringOperationsTest, SplitRangeEarlyExit)
+{
+    string_view line = "one,two,three,four";
+    auto        range = split_range(line, ',');
+
+    auto iter = std::next(range.begin(), 2);
+    EXPECT_EQ("three", *iter);
+    EXPECT_EQ(line.data() + 8, iter->data());
+    EXPECT_NE(range.end(), iter);
+    EXPECT_EQ(range.end(), std::next(iter, 2));
+}
+
+TEST(StringOperationsTest, SplitInto)
+{
+    std::vector<string_view> fields;
+    EXPECT_EQ(3u, split_into("a,b,c", ',', fields));
+    EXPECT_EQ(vector<string_view>({"a", "b", "c"}), fields);
+
+    // tokens are appended and the capacity is reused
+    auto capacity = fields.capacity();
+    fields.clear();
+    EXPECT_EQ(2u, split_into("d, e", ",", fields, split_opt::trim));
+    EXPECT_EQ(vector<string_view>({"d", "e"}), fields);
+    EXPECT_EQ(capacity, fields.capacity());
+
+    EXPECT_EQ(1u, split_into(",,f,", ',', fields, split_opt::no_empty));
+    EXPECT_EQ(vector<string_view>({"d", "e", "f"}), fields);
+
+    std::vector<std::string> owned;
+    EXPECT_EQ(2u, split_into("a;;b", std::string(";;"), owned));
+    EXPECT_EQ(vector<string>({"a", "b"}), owned);
+}
+
+TEST(StringOperationsTest, SplitIntoFixedCapacity)
+{
+    std::array<string_view, 3> fields;
+    EXPECT_EQ(2u, split_into("a,b", ',', fields));
+    EXPECT_EQ("a", fields[0]);
+    EXPECT_EQ("b", fields[1]);
+
+    EXPECT_EQ(3u, split_into("1,2,3,4,5", ',', fields));
+    EXPECT_EQ("1", fields[0]);
+    EXPECT_EQ("2", fields[1]);
+    EXPECT_EQ("3", fields[2]);
+
+    string_view single;
+    EXPECT_EQ(1u, split_into("x--y", "--", &single, 1));
+    EXPECT_EQ("x", single);
+    EXPECT_EQ(0u, split_into("x--y", "--", &single, 0));
+}
+
+TEST(StringOperationsTest, SplitArray)
+{
+    constexpr auto request = split_array<3>("GET /index.html HTTP/1.1", ' ');
+    static_assert(request[0] == "GET");
+    static_assert(request[1] == "/index.html");
+    static_assert(request[2] == "HTTP/1.1");
+
+    constexpr auto header = split_array<2>("Content-Type:  text/plain ", ":", split_opt::trim);
+    static_assert(header[0] == "Content-Type" && header[1] == "text/plain");
+
+    // missing fields are empty, splitting stops when the fields are filled in
+    constexpr auto fields = split_array<4>("a,,b", ',', split_opt::no_empty);
+    static_assert(fields[0] == "a" && fields[1] == "b" && fields[2].empty() && fields[3].empty());
+
+    // like splitted_view, the input is the only field when no_empty leaves no token
+    constexpr auto delimiters = split_array<2>(" ,, ", ',', split_opt::trim | split_opt::no_empty);
+    static_assert(delimiters[0] == ",," && delimiters[1].empty());
+
+    auto runtime = split_array<2>(std::string("1<>2<>3"), "<>");
+    EXPECT_EQ("1", runtime[0]);
+    EXPECT_EQ("2", runtime[1]);
+
+    auto noDelimiter = split_array<2>("abc", "");
+    EXPECT_EQ("abc", noDelimiter[0]);
+    EXPECT_TRUE(noDelimiter[1].empty());
+}
+
+TEST(StringOperationsTest, ConstexprHelpers)
+{
+    static_assert(trimmed_view("  key \t") == "key");
+    static_assert(trimmed_view("--key--", char_set("-")) == "key");
+    static_assert(trimmed_view("   ").empty());
+
+    static_assert(startsWith("Content-Length", "Content-"));
+    static_assert(!startsWith("Content", "Content-Length"));
+    static_assert(endsWith("config.json", ".json"));
+    static_assert(!endsWith("json", "config.json"));
+
+    static_assert(utils::str::find("key=value", "=") == 3);
+    static_assert(utils::str::find("key=value", "=", 4) == std::string_view::npos);
+    static_assert(utils::str::find("abc", "", 1) == 1);
+
+    // the runtime implementations give the same results
+    std::string key = "  key \t";
+    EXPECT_EQ("key", trimmed_view(key));
+    EXPECT_EQ(3u, utils::str::find(std::string("key=value"), "="));
+}
+
+TEST(StringOperationsTest, SplitArena)
+{
+    // the arena may not fall back to the heap
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+    auto tokens = split("a long token that does not fit in the small string buffer,b, c", ',', arena, split_opt::trim);
+    ASSERT_EQ(3u, tokens.size());
+    EXPECT_EQ("a long token that does not fit in the small string buffer", tokens[0]);
+    EXPECT_EQ("b", tokens[1]);
+    EXPECT_EQ("c", tokens[2]);
+    EXPECT_EQ(&arena, tokens[0].get_allocator().resource());
+
+    tokens = split("one<>two", "<>", arena);
+    EXPECT_EQ(2u, tokens.size());
+    EXPECT_EQ("two", tokens[1]);
+}
+
+TEST(StringOperationsTest, SplitOverlappingDelimiter)
+{
+    EXPECT_EQ(vector<string_view>({"a", ""}), splitted_view("aab", "ab"));
+    EXPECT_EQ(vector<string_view>({"x", "y"}), splitted_view("xaaby", "aab"));
+    EXPECT_EQ(vector<string_view>({"", "a"}), splitted_view("aaa", "aa"));
+    EXPECT_EQ(vector<string_view>({"1", "2", "3"}), splitted_view("1<<>2<<>3", "<<>"));
+    EXPECT_EQ(vector<string_view>({"a\r", "b"}), splitted_view("a\r\r\nb", "\r\n"));
+    EXPECT_EQ(vector<string>({"ab", "", "c"}), split("ab--------c", "----"));
+
+    std::string overlapping = "aabab";
+    replace(overlapping, "aab", "xb");
+    EXPECT_EQ("xbab", overlapping);
+}
+
+TEST(StringOperationsTest, FindAllInstructionSets)
+{
+    std::string haystack;
+    for (int i = 0; i < 300; ++i)
+    {
+        haystack += static_cast<char>('a' + (i % 7));
+    }
+    haystack += "needle_in_haystack";
+    haystack += haystack;
+
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : {utils::simd::InstructionSet::Scalar, utils::simd::InstructionSet::Sse2, utils::simd::InstructionSet::Avx2})
+    {
+        utils::simd::setInstructionSet(set);
+
+        for (string_view search : {"", "a", "ab", "abc", "gab", "needle", "needle_in_haystack", "haystacka", "notfound", "aa"})
+        {
+            for (size_t pos : {0, 1, 17, 100, 317, 600})
+            {
+                EXPECT_EQ(string_view(haystack).find(search, pos), find(haystack, search, pos)) << search << " " << pos;
+            }
+        }
+
+        EXPECT_EQ(string_view::npos, find("abc", "abcd"));
+        EXPECT_EQ(string_view::npos, find("abc", "a", 4));
+        EXPECT_EQ(3u, find("abc", "", 3));
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
 TEST(StringOperationsTest, ToString)
 {
     EXPECT_STREQ("42", toString(42).c_str());
     EXPECT_STREQ("-42", toString(-42).c_str());
     EXPECT_STREQ("42.0001", toString(42.0001f).c_str());
     EXPECT_STREQ("-42.0001", toString(-42.0001).c_str());
+    EXPECT_EQ("0", toString(0));
+    EXPECT_EQ("18446744073709551615", toString(std::numeric_limits<uint64_t>::max()));
+    EXPECT_EQ("-9223372036854775808", toString(std::numeric_limits<int64_t>::min()));
+    EXPECT_EQ("0.1", toString(0.1));
+    EXPECT_EQ("1e+100", toString(1e100));
+    EXPECT_EQ("abc", toString("abc"));
+    EXPECT_EQ("a", toString('a'));
+    EXPECT_EQ("1", toString(true));
+    EXPECT_EQ("A", toString(uint8_t(65)));
+
+    // floating point values are formatted as a stream does: 6 significant digits
+    EXPECT_EQ("0.3", toString(0.1 + 0.2));
+    EXPECT_EQ("0.333333", toString(1.0 / 3.0));
+    EXPECT_EQ("1.23457e+08", toString(123456789.123456789));
+    EXPECT_EQ("1e-05", toString(0.00001));
+
+    // matches the stream output
+    for (double value : {0.1 + 0.2, 1.0 / 3.0, 123456789.123456789, -2.2250738585072014e-308, 1e15, 123456.5, 0.0001})
+    {
+        std::ostringstream ss;
+        ss << value;
+        EXPECT_EQ(ss.str(), toString(value));
+    }
+}
+
+TEST(StringOperationsTest, ToChars)
+{
+    char buffer[MaxNumericLength];
+    EXPECT_EQ("0.30000000000000004", std::string_view(buffer, toChars(0.1 + 0.2, buffer)));
+    EXPECT_EQ("-42", std::string_view(buffer, toChars(-42, buffer)));
+
+    // the shortest representation converts back to the same value
+    for (double value : {0.1 + 0.2, 1.0 / 3.0, 123456789.123456789, -2.2250738585072014e-308})
+    {
+        EXPECT_EQ(value, toNumeric<double>(std::string_view(buffer, toChars(value, buffer))));
+    }
 }
 
 TEST(StringOperationsTest, ToWstring)
@@ -267,6 +836,8 @@ TEST(StringOperationsTest, ToWstring)
     EXPECT_EQ(std::wstring(L"-42"), toWstring(-42));
     EXPECT_EQ(std::wstring(L"42.0001"), toWstring(42.0001f));
     EXPECT_EQ(std::wstring(L"-42.0001"), toWstring(-42.0001));
+    EXPECT_EQ(std::wstring(L"a"), toWstring('a'));
+    EXPECT_EQ(std::wstring(L"0.333333"), toWstring(1.0 / 3.0));
 }
 
 TEST(StringOperationsTest, ToNumeric)
@@ -275,12 +846,128 @@ TEST(StringOperationsTest, ToNumeric)
     EXPECT_EQ(-42, toNumeric<int>("-42"));
     EXPECT_FLOAT_EQ(42.0001f, toNumeric<float>("42.0001"));
     EXPECT_FLOAT_EQ(-42.0001f, toNumeric<float>("-42.0001"));
+    EXPECT_DOUBLE_EQ(1500.0, toNumeric<double>("1.5e3"s));
+    EXPECT_EQ(65535u, toNumeric<uint16_t>("65535"));
+
+    EXPECT_THROW(toNumeric<int>(""), std::invalid_argument);
+    EXPECT_THROW(toNumeric<int>("abc"), std::invalid_argument);
+    EXPECT_THROW(toNumeric<int>("42abc"), std::invalid_argument);
+    EXPECT_THROW(toNumeric<uint16_t>("65536"), std::out_of_range);
+    EXPECT_THROW(toNumeric<int>("99999999999"), std::out_of_range);
+
+    // surrounding whitespace is accepted, other characters are not
+    EXPECT_EQ(5, toNumeric<int>(" 5"));
+    EXPECT_EQ(5, toNumeric<int>("5 "));
+    EXPECT_DOUBLE_EQ(1.5, toNumeric<double>("\t1.5\n"));
+    EXPECT_THROW(toNumeric<int>(" "), std::invalid_argument);
+    EXPECT_THROW(toNumeric<int>("5 5"), std::invalid_argument);
+    EXPECT_FALSE(parse<int>(" 5"));
+
+    // a leading '+' is accepted
+    EXPECT_EQ(5, toNumeric<int>("+5"));
+    EXPECT_EQ(5u, toNumeric<unsigned>(" +5"));
+    EXPECT_DOUBLE_EQ(1.5, toNumeric<double>("+1.5"));
+    EXPECT_THROW(toNumeric<int>("+"), std::invalid_argument);
+    EXPECT_THROW(toNumeric<int>("+-5"), std::invalid_argument);
+    EXPECT_FALSE(parse<int>("+5"));
+}
+
+TEST(StringOperationsTest, ToNumericStreamFallback)
+{
+    // bool, character and other types are extracted with a stream
+    EXPECT_EQ('a', toNumeric<char>("a"));
+    EXPECT_EQ('a', toNumeric<char>(" a"));
+    EXPECT_TRUE(toNumeric<bool>("1"));
+    EXPECT_FALSE(toNumeric<bool>("0"));
+    EXPECT_EQ("abc", toNumeric<std::string>("abc def"));
+    EXPECT_THROW(toNumeric<bool>("yes"), std::invalid_argument);
+    EXPECT_THROW(toNumeric<char>(""), std::invalid_argument);
+
+    // uint8_t is a character type, so it round trips with toString
+    EXPECT_EQ(uint8_t(255), toNumeric<uint8_t>(toString(uint8_t(255))));
+    EXPECT_EQ(uint8_t('2'), toNumeric<uint8_t>("255"));
+}
+
+TEST(StringOperationsTest, Parse)
+{
+    EXPECT_EQ(42, parse<int>("42").value());
+    EXPECT_EQ(-42, *parse<int64_t>("-42"));
+    EXPECT_DOUBLE_EQ(-0.5, *parse<double>("-0.5"));
+    EXPECT_TRUE(std::isinf(*parse<double>("inf")));
+
+    auto invalid = parse<int>("4 2");
+    EXPECT_FALSE(invalid);
+    EXPECT_FALSE(invalid.has_value());
+    EXPECT_EQ(std::errc::invalid_argument, invalid.error());
+    EXPECT_EQ(7, invalid.value_or(7));
+
+    EXPECT_EQ(std::errc::invalid_argument, parse<int>(" 42").error());
+    EXPECT_EQ(std::errc::invalid_argument, parse<int>("+42").error());
+    EXPECT_EQ(std::errc::invalid_argument, parse<unsigned>("-1").error());
+    EXPECT_EQ(std::errc::invalid_argument, parse<float>("").error());
+    EXPECT_EQ(std::errc::result_out_of_range, parse<int16_t>("40000").error());
+    EXPECT_EQ(std::errc::result_out_of_range, parse<float>("1e100").error());
+}
+
+TEST(StringOperationsTest, ParseAll)
+{
+    auto fields = splitted_view("1,2,3,4", ',');
+
+    std::array<int, 4> values;
+    EXPECT_EQ(4u, parse_all(fields, values.data()));
+    EXPECT_EQ((std::array<int, 4>{{1, 2, 3, 4}}), values);
+
+    std::vector<double> doubles;
+    EXPECT_EQ(2u, parse_all(split_range("1.5;-2;x;4", ';'), doubles));
+    EXPECT_EQ(std::vector<double>({1.5, -2.0}), doubles);
+
+    // values are appended
+    EXPECT_EQ(1u, parse_all(std::vector<std::string>{"3"}, doubles));
+    EXPECT_EQ(std::vector<double>({1.5, -2.0, 3.0}), doubles);
 }
 
 TEST(StringOperationsTest, UrlEncode)
 {
-    EXPECT_EQ("!%40%23%24%25%5e%26*()fsdkjh+", urlEncode("!@#$%^&*()fsdkjh "));
-    EXPECT_EQ("Trentem%c3%b8ller", urlEncode("Trentemøller"));
+    EXPECT_EQ("%21%40%23%24%25%5E%26*%28%29fsdkjh+", urlEncode("!@#$%^&*()fsdkjh "));
+    EXPECT_EQ("Trentem%C3%B8ller", urlEncode("Trentemøller"));
+    EXPECT_EQ("%0A%00%FF", urlEncode("\n\0\xFF"s));
+    EXPECT_EQ("", urlEncode(""));
+
+    EXPECT_EQ("a%20b%2Bc~d%2A", urlEncode("a b+c~d*", url_encoding::rfc3986));
+    EXPECT_EQ("a+b%2Bc%7Ed*", urlEncode("a b+c~d*", url_encoding::form));
+
+    std::string input = "key=some value&other=\xC3\xB8";
+    std::array<char, 64> buffer;
+    ASSERT_GE(buffer.size(), urlEncodedSize(input));
+    auto size = urlEncode(input, buffer.data());
+    EXPECT_EQ(urlEncodedSize(input), size);
+    EXPECT_EQ("key%3Dsome+value%26other%3D%C3%B8", std::string_view(buffer.data(), size));
+}
+
+TEST(StringOperationsTest, UrlDecode)
+{
+    EXPECT_EQ("!@#$%^&*()fsdkjh ", urlDecode("%21%40%23%24%25%5E%26*%28%29fsdkjh+"));
+    EXPECT_EQ("Trentemøller", urlDecode("Trentem%c3%b8ller"));
+    EXPECT_EQ("a+b c", urlDecode("a+b%20c", url_encoding::rfc3986));
+    EXPECT_EQ("a b c", urlDecode("a+b%20c", url_encoding::form));
+    EXPECT_EQ("\n\0\xFF"s, urlDecode("%0A%00%ff"));
+
+    // malformed escapes are copied as is
+    EXPECT_EQ("%", urlDecode("%"));
+    EXPECT_EQ("%4", urlDecode("%4"));
+    EXPECT_EQ("%zz1", urlDecode("%zz1"));
+    EXPECT_EQ("100%!", urlDecode("100%!"));
+
+    std::string allBytes;
+    for (int i = 0; i < 256; ++i)
+    {
+        allBytes += static_cast<char>(i);
+    }
+
+    for (auto encoding : {url_encoding::rfc3986, url_encoding::form})
+    {
+        EXPECT_EQ(allBytes, urlDecode(urlEncode(allBytes, encoding), encoding));
+    }
 }
 
 TEST(StringOperationsTest, Trim)
@@ -303,6 +990,93 @@ TEST(StringOperationsTest, TrimInPlace)
     str = std::string("please trim me.");
     trim_in_place(str);
     EXPECT_EQ("please trim me."s, str);
+
+    str = std::string("--a-b--");
+    trim_in_place(str, char_set("-"));
+    EXPECT_EQ("a-b"s, str);
+}
+
+TEST(StringOperationsTest, CharSet)
+{
+    constexpr char_set separators(",;,");
+    static_assert(separators.contains(','));
+    static_assert(separators.contains(';'));
+    static_assert(!separators.contains(' '));
+    static_assert(separators.size() == 2);
+    static_assert(whitespace.contains('\t'));
+    static_assert(!whitespace.contains('\0'));
+
+    constexpr char_set highBytes("\x80\xFF");
+    static_assert(highBytes.contains('\xFF'));
+    static_assert(!highBytes.contains('\x7F'));
+}
+
+static std::string_view trimmedReference(std::string_view str, std::string_view chars)
+{
+    auto begin = str.find_first_not_of(chars);
+    if (begin == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+
+    return str.substr(begin, str.find_last_not_of(chars) + 1 - begin);
+}
+
+TEST(StringOperationsTest, TrimAllInstructionSets)
+{
+    // sets that are vectorized and a set that is too large to be vectorized
+    const std::string largeSet = " \t\r\nabcdefghijklmnopqrstuvwxyz";
+    const std::vector<std::string_view> sets = {" \t\r\n", "-", largeSet};
+
+    std::vector<std::string> inputs;
+    for (size_t padding : {0, 1, 15, 16, 17, 31, 32, 33, 100})
+    {
+        for (size_t content : {0, 1, 2, 40})
+        {
+            std::string input;
+            for (size_t i = 0; i < padding; ++i)
+            {
+                input += " \t\r\n-"[i % 5];
+            }
+
+            input += std::string(content, 'X');
+            if (content > 1)
+            {
+                input[padding + content / 2] = ' ';
+            }
+
+            for (size_t i = 0; i < padding / 2; ++i)
+            {
+                input += "\n- "[i % 3];
+            }
+
+            inputs.push_back(input);
+        }
+    }
+
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : {utils::simd::InstructionSet::Scalar, utils::simd::InstructionSet::Sse2, utils::simd::InstructionSet::Avx2})
+    {
+        utils::simd::setInstructionSet(set);
+
+        for (auto chars : sets)
+        {
+            char_set charSet(chars);
+            for (auto& input : inputs)
+            {
+                EXPECT_EQ(trimmedReference(input, chars), trimmed_view(input, charSet)) << '"' << input << '"';
+            }
+
+            std::vector<std::string_view> tokens(inputs.begin(), inputs.end());
+            trim_all(tokens, charSet);
+            for (size_t i = 0; i < tokens.size(); ++i)
+            {
+                EXPECT_EQ(trimmedReference(inputs[i], chars), tokens[i]);
+            }
+        }
+    }
+
+    utils::simd::setInstructionSet(detected);
 }
 
 TEST(StringOperationsTest, JoinStrings)
@@ -348,6 +1122,74 @@ TEST(StringOperationsTest, JoinStreamables)
     EXPECT_EQ("one", join<std::vector<string>>({"one"}, ","));
 }
 
+TEST(StringOperationsTest, JoinNumbers)
+{
+    EXPECT_EQ("1, -2, 3", join(std::vector<int>{1, -2, 3}, ", "));
+    EXPECT_EQ("0.5;1e+20", join(std::vector<double>{0.5, 1e20}, ";"));
+    EXPECT_EQ("a-b", join(std::vector<char>{'a', 'b'}, "-"));
+
+    // same output as streaming the items
+    EXPECT_EQ("0.3;0.333333", join(std::vector<double>{0.1 + 0.2, 1.0 / 3.0}, ";"));
+    EXPECT_EQ("1,0", join(std::array<bool, 2>{true, false}, ","));
+    EXPECT_EQ("A,B", join(std::vector<uint8_t>{65, 66}, ","));
+    EXPECT_EQ("", join(std::vector<int>(), ", "));
+}
+
+TEST(StringOperationsTest, JoinCallback)
+{
+    EXPECT_EQ("2,4,6", join(std::vector<int>{1, 2, 3}, ",", [](int i) { return i * 2; }));
+    EXPECT_EQ("<1>,<2>", join(std::vector<int>{1, 2}, ",", [](int i) { return "<" + std::to_string(i) + ">"; }));
+}
+
+TEST(StringOperationsTest, JoinLazyRanges)
+{
+    EXPECT_EQ("a;b;c", join(split_range("a, b ,c", ',', split_opt::trim), ";"));
+    EXPECT_EQ("", join(split_range("", ',', split_opt::no_empty), ";"));
+
+    // input iterators can only be traversed once
+    std::istringstream input("1 2 3");
+    struct
+    {
+        std::istream_iterator<int> first;
+        std::istream_iterator<int> last;
+
+        auto begin() const { return first; }
+        auto end() const { return last; }
+    } numbers{std::istream_iterator<int>(input), std::istream_iterator<int>()};
+
+    EXPECT_EQ("1+2+3", join(numbers, "+"));
+}
+
+TEST(StringOperationsTest, JoinInto)
+{
+    std::string output = "values: ";
+    join_into(output, std::vector<std::string>{"a", "b"}, ", ");
+    EXPECT_EQ("values: a, b", output);
+
+    join_into(output, std::vector<int>{1, 2}, ", ", [](int i) { return i + 1; });
+    EXPECT_EQ("values: a, b2, 3", output);
+
+    // any buffer with an append(begin, end) member
+    struct Buffer
+    {
+        void append(const char* begin, const char* end)
+        {
+            data.insert(data.end(), begin, end);
+        }
+
+        void push_back(char c)
+        {
+            data.push_back(c);
+        }
+
+        std::vector<char> data;
+    } buffer;
+
+    join_into(buffer, split_range("x|y|z", '|'), "");
+    join_into(buffer, std::vector<Streamable>{{1}, {2}}, ",");
+    EXPECT_EQ("xyz1,2", std::string(buffer.data.begin(), buffer.data.end()));
+}
+
 TEST(StringOperationsTest, StartsWith)
 {
     EXPECT_TRUE(startsWith("TestOne", ""));
@@ -0,0 +1,64 @@
+//    Copyright (C) 2018 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/timeoperations.h"
+#include "gtest/gtest.h"
+
+using namespace utils;
+using namespace std::chrono;
+
+TEST(TimeOperationsTest, FormatTimeMatchesGetTimeString)
+{
+    auto now = system_clock::now();
+
+    char buffer[16];
+    auto size = timeops::formatTime(now, buffer);
+    EXPECT_EQ(timeops::getTimeString(now), std::string(buffer, size));
+
+    // second call is served from the cache
+    size = timeops::formatTime(now + milliseconds(1), buffer);
+    EXPECT_EQ(timeops::getTimeString(now + milliseconds(1)), std::string(buffer, size));
+}
+
+TEST(TimeOperationsTest, FormatTimeFraction)
+{
+    auto second = system_clock::from_time_t(timeops::getTime());
+
+    char buffer[16];
+    auto size = timeops::formatTime(second + microseconds(7008), buffer);
+    ASSERT_EQ(12u, size);
+    EXPECT_EQ(".007", std::string(buffer + 8, 4));
+
+    size = timeops::formatTime(second + microseconds(7008), buffer, timeops::TimePrecision::Microseconds);
+    ASSERT_EQ(15u, size);
+    EXPECT_EQ(".007008", std::string(buffer + 8, 7));
+
+    size = timeops::formatTime(second + microseconds(999999), buffer, timeops::TimePrecision::Microseconds);
+    EXPECT_EQ(timeops::getTimeString(second).substr(0, 8), std::string(buffer, 8));
+    EXPECT_EQ(".999999", std::string(buffer + 8, 7));
+}
+
+TEST(TimeOperationsTest, CoarseClocks)
+{
+    auto diff = timeops::coarse_system_clock::now() - system_clock::now();
+    EXPECT_LT(duration_cast<milliseconds>(diff).count(), 100);
+    EXPECT_GT(duration_cast<milliseconds>(diff).count(), -100);
+
+    auto steadyDiff = timeops::coarse_steady_clock::now() - steady_clock::now();
+    EXPECT_LT(duration_cast<milliseconds>(steadyDiff).count(), 100);
+    EXPECT_GT(duration_cast<milliseconds>(steadyDiff).count(), -100);
+}
@@ -0,0 +1,315 @@
+//    Copyright (C) 2012 Dirk Vanden Boer <dirk.vdb@gmail.com>
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+
+#include "utils/utf8.h"
+#include "src/simd.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace utils::str;
+using namespace testing;
+
+namespace
+{
+
+const auto AllInstructionSets = {utils::simd::InstructionSet::Scalar, utils::simd::InstructionSet::Sse2, utils::simd::InstructionSet::Avx2};
+
+// straightforward validation following the well-formed byte sequences table of the unicode standard
+bool referenceValidate(std::string_view str)
+{
+    auto in = [](unsigned char c, int low, int high) { return c >= low && c <= high; };
+
+    size_t i = 0;
+    while (i < str.size())
+    {
+        auto b = [&](size_t offset) { return i + offset < str.size() ? static_cast<unsigned char>(str[i + offset]) : 0; };
+        auto c = b(0);
+
+        if (c <= 0x7F) { i += 1; }
+        else if (in(c, 0xC2, 0xDF) && in(b(1), 0x80, 0xBF)) { i += 2; }
+        else if (c == 0xE0 && in(b(1), 0xA0, 0xBF) && in(b(2), 0x80, 0xBF)) { i += 3; }
+        else if ((in(c, 0xE1, 0xEC) || in(c, 0xEE, 0xEF)) && in(b(1), 0x80, 0xBF) && in(b(2), 0x80, 0xBF)) { i += 3; }
+        else if (c == 0xED && in(b(1), 0x80, 0x9F) && in(b(2), 0x80, 0xBF)) { i += 3; }
+        else if (c == 0xF0 && in(b(1), 0x90, 0xBF) && in(b(2), 0x80, 0xBF) && in(b(3), 0x80, 0xBF)) { i += 4; }
+        else if (in(c, 0xF1, 0xF3) && in(b(1), 0x80, 0xBF) && in(b(2), 0x80, 0xBF) && in(b(3), 0x80, 0xBF)) { i += 4; }
+        else if (c == 0xF4 && in(b(1), 0x80, 0x8F) && in(b(2), 0x80, 0xBF) && in(b(3), 0x80, 0xBF)) { i += 4; }
+        else { return false; }
+    }
+
+    return true;
+}
+
+}
+
+TEST(Utf8Test, Validate)
+{
+    const std::vector<std::string> valid = {
+        "",
+        "ascii only",
+        u8"été",
+        u8"€ 100",
+        u8"\U0001F600 smile",
+        "\x7F",
+        "\xC2\x80",
+        "\xDF\xBF",
+        "\xE0\xA0\x80",
+        "\xED\x9F\xBF",
+        "\xEE\x80\x80",
+        "\xEF\xBF\xBF",
+        "\xF0\x90\x80\x80",
+        "\xF4\x8F\xBF\xBF",
+    };
+
+    const std::vector<std::string> invalid = {
+        "\x80",                 // lone continuation byte
+        "\xBF",
+        "\xC0\x80",             // overlong NUL
+        "\xC1\xBF",             // overlong 2 byte
+        "\xE0\x80\x80",         // overlong 3 byte
+        "\xE0\x9F\xBF",
+        "\xF0\x80\x80\x80",     // overlong 4 byte
+        "\xF0\x8F\xBF\xBF",
+        "\xED\xA0\x80",         // surrogates
+        "\xED\xBF\xBF",
+        "\xF4\x90\x80\x80",     // above U+10FFFF
+        "\xF5\x80\x80\x80",
+        "\xFF",
+        "\xC2",                 // truncated
+        "\xE2\x82",
+        "\xF0\x9F\x98",
+        "\xC2\x41",             // continuation byte missing
+        "\xE2\x41\xAC",
+        "\xE2\x82\xAC\xAC",     // too many continuation bytes
+    };
+
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : AllInstructionSets)
+    {
+        utils::simd::setInstructionSet(set);
+
+        for (auto& str : valid)
+        {
+            EXPECT_TRUE(is_valid_utf8(str)) << str;
+
+            // at every offset of a block and across the block boundaries
+            for (size_t offset = 0; offset < 70; ++offset)
+            {
+                auto padded = std::string(offset, 'a') + str + std::string(offset % 7, 'b');
+                EXPECT_TRUE(is_valid_utf8(padded)) << offset;
+            }
+        }
+
+        for (auto& str : invalid)
+        {
+            EXPECT_FALSE(is_valid_utf8(str)) << str;
+
+            for (size_t offset = 0; offset < 70; ++offset)
+            {
+                auto padded = std::string(offset, 'a') + str + std::string(offset % 7, 'b');
+                EXPECT_FALSE(is_valid_utf8(padded)) << offset;
+
+                auto multiByte = std::string(u8"é€\U0001F600") + std::string(offset, 'a') + str + u8"é";
+                EXPECT_FALSE(is_valid_utf8(multiByte)) << offset;
+            }
+        }
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+TEST(Utf8Test, ValidateAllShortSequences)
+{
+    // every sequence of up to 3 bytes and every 4 byte sequence with a relevant lead byte
+    std::string str(4, '\0');
+
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : AllInstructionSets)
+    {
+        utils::simd::setInstructionSet(set);
+
+        for (int b0 = 0x80; b0 < 0x100; ++b0)
+        {
+            for (int b1 = 0; b1 < 0x100; ++b1)
+            {
+                str.assign({char(b0), char(b1)});
+                ASSERT_EQ(referenceValidate(str), is_valid_utf8(str)) << b0 << ' ' << b1;
+
+                for (int b2 : {0x00, 0x41, 0x80, 0x9F, 0xA0, 0xBF, 0xC0, 0xC2, 0xE0, 0xF0, 0xFF})
+                {
+                    str.assign({char(b0), char(b1), char(b2)});
+                    ASSERT_EQ(referenceValidate(str), is_valid_utf8(str)) << b0 << ' ' << b1 << ' ' << b2;
+
+                    for (int b3 : {0x41, 0x80, 0xBF, 0xC0})
+                    {
+                        str.assign({char(b0), char(b1), char(b2), char(b3)});
+                        ASSERT_EQ(referenceValidate(str), is_valid_utf8(str)) << b0 << ' ' << b1 << ' ' << b2 << ' ' << b3;
+                    }
+                }
+            }
+        }
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+TEST(Utf8Test, ValidateRandomData)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::uniform_int_distribution<size_t> sizeDist(0, 300);
+
+    const std::vector<std::string> pieces = {"a", "abcdefgh", u8"é", u8"€", u8"\U0001F600", u8"\U0010FFFF"};
+    std::uniform_int_distribution<size_t> pieceDist(0, pieces.size() - 1);
+
+    const auto detected = utils::simd::detectInstructionSet();
+    for (int i = 0; i < 2000; ++i)
+    {
+        // mostly valid data with a single random byte modification
+        std::string str;
+        auto size = sizeDist(rng);
+        while (str.size() < size)
+        {
+            str += pieces[pieceDist(rng)];
+        }
+
+        if (!str.empty() && i % 4 != 0)
+        {
+            str[size_t(byteDist(rng)) * 997 % str.size()] = char(byteDist(rng));
+        }
+
+        auto expected = referenceValidate(str);
+        for (auto set : AllInstructionSets)
+        {
+            utils::simd::setInstructionSet(set);
+            ASSERT_EQ(expected, is_valid_utf8(str));
+        }
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+TEST(Utf8Test, Length)
+{
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : AllInstructionSets)
+    {
+        utils::simd::setInstructionSet(set);
+
+        EXPECT_EQ(0u, utf8_length(""));
+        EXPECT_EQ(5u, utf8_length("ascii"));
+        EXPECT_EQ(3u, utf8_length(u8"été"));
+        EXPECT_EQ(2u, utf8_length(u8"€\U0001F600"));
+
+        std::string longString;
+        for (int i = 0; i < 50; ++i)
+        {
+            longString += u8"aé€\U0001F600";
+        }
+        EXPECT_EQ(200u, utf8_length(longString));
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+TEST(Utf8Test, Utf8ToUtf16)
+{
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : AllInstructionSets)
+    {
+        utils::simd::setInstructionSet(set);
+
+        EXPECT_EQ(u"", utf8_to_utf16(""));
+        EXPECT_EQ(u"ascii", utf8_to_utf16("ascii"));
+        EXPECT_EQ(u"été €", utf8_to_utf16(u8"été €"));
+        EXPECT_EQ(u"\U0001F600 \U0010FFFF", utf8_to_utf16(u8"\U0001F600 \U0010FFFF"));
+        EXPECT_EQ(std::u16string({0xD83D, 0xDE00}), utf8_to_utf16(u8"\U0001F600"));
+
+        std::string longString;
+        std::u16string expected;
+        for (int i = 0; i < 20; ++i)
+        {
+            longString += u8"some ascii text é\U0001F600";
+            expected += u"some ascii text é\U0001F600";
+        }
+        EXPECT_EQ(expected, utf8_to_utf16(longString));
+
+        EXPECT_THROW(utf8_to_utf16("\xC0\x80"), std::invalid_argument);
+        EXPECT_THROW(utf8_to_utf16("abc\xE2\x82"), std::invalid_argument);
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+TEST(Utf8Test, Utf8ToUtf32)
+{
+    const auto detected = utils::simd::detectInstructionSet();
+    for (auto set : AllInstructionSets)
+    {
+        utils::simd::setInstructionSet(set);
+
+        EXPECT_EQ(U"", utf8_to_utf32(""));
+        EXPECT_EQ(U"ascii", utf8_to_utf32("ascii"));
+        EXPECT_EQ(U"été € \U0001F600 \U0010FFFF", utf8_to_utf32(u8"été € \U0001F600 \U0010FFFF"));
+
+        EXPECT_THROW(utf8_to_utf32("\xED\xA0\x80"), std::invalid_argument);
+        EXPECT_THROW(utf8_to_utf32("\xF4\x90\x80\x80"), std::invalid_argument);
+    }
+
+    utils::simd::setInstructionSet(detected);
+}
+
+TEST(Utf8Test, Utf16ToUtf8)
+{
+    EXPECT_EQ("", utf16_to_utf8(u""));
+    EXPECT_EQ("ascii", utf16_to_utf8(u"ascii"));
+    EXPECT_EQ(u8"été € \U0001F600 \U0010FFFF", utf16_to_utf8(u"été € \U0001F600 \U0010FFFF"));
+
+    // unpaired surrogates
+    EXPECT_THROW(utf16_to_utf8(std::u16string({0xD83D})), std::invalid_argument);
+    EXPECT_THROW(utf16_to_utf8(std::u16string({0xD83D, u'a'})), std::invalid_argument);
+    EXPECT_THROW(utf16_to_utf8(std::u16string({0xDE00, 0xD83D})), std::invalid_argument);
+}
+
+TEST(Utf8Test, Utf32ToUtf8)
+{
+    EXPECT_EQ("", utf32_to_utf8(U""));
+    EXPECT_EQ(u8"aé€\U0001F600\U0010FFFF", utf32_to_utf8(U"aé€\U0001F600\U0010FFFF"));
+
+    EXPECT_THROW(utf32_to_utf8(std::u32string({0xD800})), std::invalid_argument);
+    EXPECT_THROW(utf32_to_utf8(std::u32string({0x110000})), std::invalid_argument);
+}
+
+TEST(Utf8Test, RoundTrip)
+{
+    std::u32string all;
+    for (char32_t c = 1; c < 0x110000; c += 7)
+    {
+        if (c < 0xD800 || c > 0xDFFF)
+        {
+            all += c;
+        }
+    }
+
+    auto utf8 = utf32_to_utf8(all);
+    EXPECT_TRUE(is_valid_utf8(utf8));
+    EXPECT_EQ(all.size(), utf8_length(utf8));
+    EXPECT_EQ(all, utf8_to_utf32(utf8));
+    EXPECT_EQ(utf8, utf16_to_utf8(utf8_to_utf16(utf8)));
+}